@@ -1,6 +1,6 @@
 /**
  * @file analyseur_telemetrie.cpp
- * @brief Analyseur de trames de télémétrie pour bras robotisé 6 axes
+ * @brief Analyseur de trames de télémétrie pour bras robotisé 6 axes (ou cobot 7 axes)
  * 
  * Ce programme lit des données de télémétrie depuis un fichier ou l'entrée
  * standard (stdin), détecte et décode les trames, puis produit un rapport.
@@ -25,45 +25,301 @@
 #include <fstream>
 #include <cstdint>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <string>
 #include <vector>
 #include <iomanip>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <cstddef>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "protocole_telemetrie.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 // ============================================================================
 // Constantes du protocole
 // ============================================================================
 
-const uint8_t SYNC_H = 0xAA;
-const uint8_t SYNC_L = 0x55;
-const size_t NB_AXES = 6;
-const size_t TAILLE_AXE = 6;        // 2 + 2 + 2 octets
-const size_t TAILLE_ENTETE = 3;     // sync1 + sync2 + sequence
-const size_t TAILLE_TRAME = TAILLE_ENTETE + NB_AXES * TAILLE_AXE;  // 39 octets
+// Sync, en-tête et disposition par modèle de bras : protocole_telemetrie.h
+const size_t TAILLE_TRAME = DispositionTrame<NB_AXES_BRAS>::taille;   // 39 octets (bras à 6 axes)
+const size_t TAILLE_MAX_TRAME = taille_trame_axes(MAX_AXES) + TAILLE_CRC;
+
+// Taille d'un bloc lu par read(2) en mode flux
+const size_t TAILLE_BLOC_LECTURE = 64 * 1024;
+
+// Entrée réseau (udp:, tcp:) : tampon de réception demandé au noyau, et
+// place réservée par datagramme dans un bloc (une ou plusieurs trames)
+const int TAILLE_TAMPON_SOCKET = 8 * 1024 * 1024;
+const size_t TAILLE_MAX_DATAGRAMME = 2048;
+const size_t NB_MAX_DATAGRAMMES = TAILLE_BLOC_LECTURE / TAILLE_MAX_DATAGRAMME;
+
+// Taille des fenêtres parcourues dans un fichier mappé (garde les positions
+// retournées par trouver_sync() dans les limites d'un int)
+const size_t TAILLE_FENETRE_CARTE = 16 * 1024 * 1024;
+
+// Nombre de trames décodées ensemble en colonnes avant analyse
+const size_t TAILLE_LOT = 1024;
+
+// Tampon de texte du rapport, écrit d'un bloc dans le flux de sortie
+const size_t TAILLE_TAMPON_SORTIE = 1024 * 1024;
+const size_t TAILLE_MAX_RAPPORT_TRAME = 512;   // Une trame, 7 axes en alerte compris
+
+// Octets parcourus avant le début d'un segment en mode parallèle (-j), pour
+// que la recherche de sync s'y cale sur les vraies trames
+const size_t RECOUVREMENT_SEGMENT = 16 * TAILLE_TRAME;
+
+// Taille visée d'un segment (-j) : le rapport d'un segment attend en mémoire
+// que les précédents soient écrits, et au plus SEGMENTS_PAR_FIL segments par
+// fil sont en cours à la fois
+const size_t TAILLE_SEGMENT = 1024 * 1024;
+const size_t SEGMENTS_PAR_FIL = 2;
+
+// Fichier colonnaire (--columns) : position, vitesse, courant par axe + séquence
+constexpr size_t nb_colonnes(size_t nb_axes) { return 3 * nb_axes + 1; }
+const uint16_t VERSION_COLONNES = 1;
+
+// Position « aucune trame » retournée par chercher_sync()
+const size_t AUCUNE_POSITION = SIZE_MAX;
 
 // ============================================================================
 // Structures de données
 // ============================================================================
 
-// TODO 1: Définir les structures pour les trames et les données des axes. 
-// Attention: Pensez à l'alignement des structures!
+// Structures compactes : leur disposition mémoire est celle du protocole
+#pragma pack(push, 1)
 
 struct DonneesAxe {
-    // TODO
     int16_t position; //centieme de degre
     int16_t vitesse; //dixieme de degre/seconde
     uint16_t courant; //milliamp'res
-    
 };
 
-struct Trame {
-    // TODO
+// Trame d'un bras à Axes axes (voir DispositionTrame)
+template <size_t Axes>
+struct TrameAxes {
     uint8_t sync1;
     uint8_t sync2;
     uint8_t sequence;
-    DonneesAxe axe1[NB_AXES];
-    DonneesAxe axe2[NB_AXES];
+    DonneesAxe axes[Axes];
+};
+
+#pragma pack(pop)
+
+using Trame = TrameAxes<NB_AXES_BRAS>;
+using TrameCobot = TrameAxes<NB_AXES_COBOT>;
+
+// Le format sur le fil est fixé à la compilation
+static_assert(sizeof(DonneesAxe) == TAILLE_AXE, "DonneesAxe doit faire 6 octets");
+static_assert(sizeof(Trame) == DispositionTrame<NB_AXES_BRAS>::taille, "Trame doit faire 39 octets");
+static_assert(sizeof(TrameCobot) == DispositionTrame<NB_AXES_COBOT>::taille,
+              "TrameCobot doit faire 45 octets");
+static_assert(offsetof(Trame, sequence) == DispositionTrame<NB_AXES_BRAS>::sequence,
+              "sequence doit suivre les 2 octets de sync");
+static_assert(offsetof(Trame, axes) == DispositionTrame<NB_AXES_BRAS>::axe(0),
+              "les axes doivent suivre l'en-tête");
+static_assert(offsetof(DonneesAxe, vitesse) == 2 && offsetof(DonneesAxe, courant) == 4,
+              "ordre des champs d'un axe : position, vitesse, courant");
+
+/**
+ * @brief Lit un entier 16 bits little-endian à une adresse quelconque
+ *
+ * memcpy évite toute lecture non alignée ; sur une machine little-endian
+ * le compilateur en fait un simple chargement.
+ */
+inline uint16_t lire_u16_le(const uint8_t* ptr) {
+    uint16_t valeur;
+    std::memcpy(&valeur, ptr, sizeof(valeur));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    valeur = __builtin_bswap16(valeur);
+#endif
+    return valeur;
+}
+
+/**
+ * @brief Lit un entier 32 bits little-endian à une adresse quelconque
+ */
+inline uint32_t lire_u32_le(const uint8_t* ptr) {
+    return static_cast<uint32_t>(lire_u16_le(ptr)) |
+           static_cast<uint32_t>(lire_u16_le(ptr + 2)) << 16;
+}
+
+/**
+ * @brief Lit un entier 64 bits little-endian à une adresse quelconque
+ */
+inline uint64_t lire_u64_le(const uint8_t* ptr) {
+    return static_cast<uint64_t>(lire_u32_le(ptr)) |
+           static_cast<uint64_t>(lire_u32_le(ptr + 4)) << 32;
+}
+
+/**
+ * @brief Vue en lecture seule sur les 6 octets d'un axe dans le tampon brut
+ */
+struct VueAxe {
+    const uint8_t* octets;
 
+    int16_t position() const { return static_cast<int16_t>(lire_u16_le(octets)); }
+    int16_t vitesse() const { return static_cast<int16_t>(lire_u16_le(octets + 2)); }
+    uint16_t courant() const { return lire_u16_le(octets + 4); }
 };
 
+/**
+ * @brief Vue en lecture seule sur une trame dans le tampon brut
+ *
+ * Les champs sont lus à la demande, directement dans le tampon d'entrée
+ * (fichier mappé ou bloc lu) : aucune copie de la trame n'est faite.
+ * Le tampon doit rester valide tant que la vue est utilisée.
+ */
+struct VueTrame {
+    const uint8_t* octets;
+
+    uint8_t sync1() const { return octets[offsetof(Trame, sync1)]; }
+    uint8_t sync2() const { return octets[offsetof(Trame, sync2)]; }
+    uint8_t sequence() const { return octets[offsetof(Trame, sequence)]; }
+    VueAxe axe(size_t i) const { return VueAxe{octets + offsetof(Trame, axes) + i * TAILLE_AXE}; }
+};
+
+/**
+ * @brief Suivi incrémental des numéros de séquence (8 bits, cycliques)
+ *
+ * Chaque séquence reçue est comparée à la plus avancée vue jusqu'ici ;
+ * l'écart, pris modulo 256 dans [-128, 127], déroule le compteur en un
+ * index 64 bits. Un écart de +n compte n - 1 trames perdues, un écart nul un
+ * doublon, un écart négatif une trame arrivée en retard (déjà comptée
+ * perdue : elle est retirée des pertes). Travail constant par trame, sans
+ * historique.
+ */
+struct SuiviSequence {
+    bool demarre = false;       // Au moins une trame (ou une base) vue
+    bool depuis_base = false;   // La première trame a été comparée à une base fournie
+    uint8_t premiere = 0;       // Séquence de la première trame
+    uint8_t courante = 0;       // Séquence de la trame la plus avancée
+    uint64_t index = 0;         // Index déroulé de cette trame (première = 0)
+    int64_t perdues = 0;        // Peut devenir négatif sur un segment isolé (-j)
+    uint64_t doublons = 0;
+    uint64_t desordres = 0;
+};
+
+/**
+ * @brief Prend en compte la séquence d'une trame reçue
+ */
+inline void suivre_sequence(SuiviSequence& suivi, uint8_t sequence) {
+    if (!suivi.demarre) {
+        suivi.demarre = true;
+        suivi.premiere = sequence;
+        suivi.courante = sequence;
+        return;
+    }
+
+    int ecart = static_cast<int8_t>(static_cast<uint8_t>(sequence - suivi.courante));
+    if (ecart > 0) {
+        suivi.perdues += ecart - 1;
+        suivi.index += static_cast<uint64_t>(ecart);
+        suivi.courante = sequence;
+    } else if (ecart == 0) {
+        suivi.doublons++;
+    } else {
+        suivi.desordres++;
+        suivi.perdues--;
+    }
+}
+
+/**
+ * @brief Enchaîne le suivi d'un segment à la suite du suivi total
+ *
+ * Exact si la première trame du segment avance la séquence (ou la répète) ;
+ * sinon le segment doit être recalculé depuis la base du total
+ * (voir analyser_en_parallele()).
+ */
+void fusionner_suivi(SuiviSequence& total, const SuiviSequence& partie) {
+    if (!partie.demarre) {
+        return;
+    }
+    if (!total.demarre) {
+        total = partie;
+        return;
+    }
+    if (!partie.depuis_base) {
+        suivre_sequence(total, partie.premiere);
+    }
+    total.index += partie.index;
+    total.perdues += partie.perdues;
+    total.doublons += partie.doublons;
+    total.desordres += partie.desordres;
+    total.courante = partie.courante;
+}
+
+/**
+ * @brief Agrégats courants d'un axe, en unités brutes
+ *
+ * Moyennes et somme des carrés des écarts du courant suivent Welford
+ * (une passe, sans somme géante) ; deux agrégats partiels se combinent par
+ * la formule de Chan, ce qui permet de les calculer par lot ou par segment.
+ * Aligné sur une ligne de cache : chaque axe est mis à jour indépendamment.
+ */
+struct alignas(64) StatistiquesAxe {
+    uint64_t nb = 0;
+    int16_t position_min = INT16_MAX;
+    int16_t position_max = INT16_MIN;
+    uint16_t vitesse_crete = 0;     // max |vitesse| (32768 compris)
+    double position_moyenne = 0.0;
+    double courant_moyen = 0.0;
+    double courant_m2 = 0.0;        // Somme des carrés des écarts à la moyenne
+};
+
+/**
+ * @brief Combine un agrégat partiel dans le total (formule de Chan)
+ */
+void fusionner_axe(StatistiquesAxe& total, const StatistiquesAxe& partie) {
+    if (partie.nb == 0) {
+        return;
+    }
+    if (total.nb == 0) {
+        total = partie;
+        return;
+    }
+    double na = static_cast<double>(total.nb);
+    double nb = static_cast<double>(partie.nb);
+    double n = na + nb;
+    double ecart_courant = partie.courant_moyen - total.courant_moyen;
+
+    total.nb += partie.nb;
+    total.position_min = std::min(total.position_min, partie.position_min);
+    total.position_max = std::max(total.position_max, partie.position_max);
+    total.vitesse_crete = std::max(total.vitesse_crete, partie.vitesse_crete);
+    total.position_moyenne += (partie.position_moyenne - total.position_moyenne) * nb / n;
+    total.courant_moyen += ecart_courant * nb / n;
+    total.courant_m2 += partie.courant_m2 + ecart_courant * ecart_courant * na * nb / n;
+}
+
 // Structure pour les statistiques (déjà complète)
 struct Statistiques {
     size_t octets_lus = 0;
@@ -72,288 +328,4056 @@ struct Statistiques {
     uint8_t sequence_min = 255;
     uint8_t sequence_max = 0;
     size_t octets_bruit = 0;
+    size_t trames_rejetees = 0; // Sync trouvé mais CRC faux (--crc) : compté en bruit
+    SuiviSequence suivi;        // Pertes, doublons et désordres de séquence
+    StatistiquesAxe axes[MAX_AXES];     // Au-delà des axes du modèle : nb == 0
+};
+
+/**
+ * @brief Additionne les suivis de flux indépendants (robots différents)
+ *
+ * Les séquences ne s'enchaînent pas : seuls les compteurs s'ajoutent, et
+ * index + 1 reste le nombre total de trames attendues.
+ */
+void cumuler_suivi(SuiviSequence& total, const SuiviSequence& partie) {
+    if (!partie.demarre) {
+        return;
+    }
+    if (!total.demarre) {
+        total = partie;
+        return;
+    }
+    total.index += partie.index + 1;
+    total.perdues += partie.perdues;
+    total.doublons += partie.doublons;
+    total.desordres += partie.desordres;
+}
+
+/**
+ * @brief Ajoute les compteurs et agrégats (tout sauf le suivi de séquence)
+ */
+void fusionner_compteurs(Statistiques& total, const Statistiques& partielle) {
+    total.octets_lus += partielle.octets_lus;
+    total.trames_valides += partielle.trames_valides;
+    total.trames_alerte += partielle.trames_alerte;
+    total.octets_bruit += partielle.octets_bruit;
+    total.trames_rejetees += partielle.trames_rejetees;
+    if (partielle.trames_valides > 0) {
+        total.sequence_min = std::min(total.sequence_min, partielle.sequence_min);
+        total.sequence_max = std::max(total.sequence_max, partielle.sequence_max);
+    }
+    for (size_t i = 0; i < MAX_AXES; i++) {
+        fusionner_axe(total.axes[i], partielle.axes[i]);
+    }
+}
+
+/**
+ * @brief Ajoute des statistiques partielles (d'un segment) au total
+ */
+void fusionner_statistiques(Statistiques& total, const Statistiques& partielle) {
+    fusionner_compteurs(total, partielle);
+    fusionner_suivi(total.suivi, partielle.suivi);
+}
+
+/**
+ * @brief Ajoute les statistiques d'un autre flux au total (--multi)
+ */
+void ajouter_statistiques_flux(Statistiques& total, const Statistiques& partielle) {
+    fusionner_compteurs(total, partielle);
+    cumuler_suivi(total.suivi, partielle.suivi);
+}
+
+
+// ============================================================================
+// Fonctions de conversion
+// ============================================================================
+
+/**
+ * @brief Convertit une position brute en degrés
+ * @param brut Valeur brute en centièmes de degré (int16_t)
+ * @return Position en degrés (float)
+ */
+float position_en_degres(int16_t brut) {
+    return brut / 100.0f;
+}
+
+/**
+ * @brief Convertit une vitesse brute en degrés par seconde
+ * @param brut Valeur brute en dixièmes de degré/seconde (int16_t)
+ * @return Vitesse en degrés/seconde (float)
+ */
+float vitesse_en_deg_s(int16_t brut) {
+    return brut / 10.0f;
+}
+
+/**
+ * @brief Convertit un courant brut en ampères
+ * @param brut Valeur brute en milliampères (uint16_t)
+ * @return Courant en ampères (float)
+ */
+float courant_en_amperes(uint16_t brut) {
+    return brut / 1000.0f;
+}
+
+// ============================================================================
+// Fonctions de détection et décodage
+// ============================================================================
+
+/**
+ * @brief Recherche octet par octet de la paire de synchronisation
+ *
+ * Version de référence, aussi utilisée pour la fin du tampon par les
+ * versions vectorielles.
+ */
+int trouver_sync_scalaire(const uint8_t* buffer, size_t taille, size_t debut) {
+    // Le dernier octet ne peut pas commencer une paire complète
+    for (size_t i = debut; i + 1 < taille; i++) {
+        if (buffer[i] == SYNC_H && buffer[i + 1] == SYNC_L) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @brief Recherche SSE2 : 16 positions candidates par itération
+ *
+ * Compare buffer[i..i+15] à SYNC_H et buffer[i+1..i+16] à SYNC_L ; le bit
+ * de poids faible du masque combiné donne la première paire.
+ */
+__attribute__((target("sse2")))
+int trouver_sync_sse2(const uint8_t* buffer, size_t taille, size_t debut) {
+    const __m128i h = _mm_set1_epi8(static_cast<char>(SYNC_H));
+    const __m128i l = _mm_set1_epi8(static_cast<char>(SYNC_L));
+    size_t i = debut;
+
+    for (; i + 17 <= taille; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i + 1));
+        __m128i paire = _mm_and_si128(_mm_cmpeq_epi8(a, h), _mm_cmpeq_epi8(b, l));
+        unsigned masque = static_cast<unsigned>(_mm_movemask_epi8(paire));
+        if (masque != 0) {
+            return static_cast<int>(i + static_cast<size_t>(__builtin_ctz(masque)));
+        }
+    }
+    return trouver_sync_scalaire(buffer, taille, i);
+}
+
+/**
+ * @brief Recherche AVX2 : 32 positions candidates par itération
+ */
+__attribute__((target("avx2")))
+int trouver_sync_avx2(const uint8_t* buffer, size_t taille, size_t debut) {
+    const __m256i h = _mm256_set1_epi8(static_cast<char>(SYNC_H));
+    const __m256i l = _mm256_set1_epi8(static_cast<char>(SYNC_L));
+    size_t i = debut;
+
+    for (; i + 33 <= taille; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i + 1));
+        __m256i paire = _mm256_and_si256(_mm256_cmpeq_epi8(a, h), _mm256_cmpeq_epi8(b, l));
+        unsigned masque = static_cast<unsigned>(_mm256_movemask_epi8(paire));
+        if (masque != 0) {
+            return static_cast<int>(i + static_cast<size_t>(__builtin_ctz(masque)));
+        }
+    }
+    return trouver_sync_sse2(buffer, taille, i);
+}
+
+#elif defined(__aarch64__)
+
+/**
+ * @brief Recherche NEON : 16 positions candidates par itération
+ *
+ * NEON n'a pas d'équivalent direct à movemask : on teste d'abord s'il existe
+ * une paire dans le bloc, puis on la localise avec la version scalaire.
+ */
+int trouver_sync_neon(const uint8_t* buffer, size_t taille, size_t debut) {
+    const uint8x16_t h = vdupq_n_u8(SYNC_H);
+    const uint8x16_t l = vdupq_n_u8(SYNC_L);
+    size_t i = debut;
+
+    for (; i + 17 <= taille; i += 16) {
+        uint8x16_t a = vld1q_u8(buffer + i);
+        uint8x16_t b = vld1q_u8(buffer + i + 1);
+        uint8x16_t paire = vandq_u8(vceqq_u8(a, h), vceqq_u8(b, l));
+        if (vmaxvq_u8(paire) != 0) {
+            return trouver_sync_scalaire(buffer, i + 17, i);
+        }
+    }
+    return trouver_sync_scalaire(buffer, taille, i);
+}
+
+#endif
+
+using FonctionSync = int (*)(const uint8_t*, size_t, size_t);
+
+/**
+ * @brief Choisit la meilleure implémentation disponible sur ce processeur
+ */
+FonctionSync choisir_trouver_sync() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return trouver_sync_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return trouver_sync_sse2;
+    }
+#elif defined(__aarch64__)
+    return trouver_sync_neon;
+#endif
+    return trouver_sync_scalaire;
+}
+
+/**
+ * @brief Recherche les octets de synchronisation dans un tampon
+ * 
+ * Parcourt le tampon à partir de la position donnée et recherche la séquence
+ * de synchronisation (0xAA 0x55). Retourne la position du premier octet de
+ * sync si trouvé, ou -1 si non trouvé.
+ * 
+ * La recherche est vectorielle (AVX2, SSE2 ou NEON) quand le processeur le
+ * permet ; l'implémentation est choisie une seule fois, au premier appel.
+ * Aucun octet au-delà de buffer[taille - 1] n'est lu.
+ * 
+ * @param buffer Pointeur vers le tampon de données
+ * @param taille Taille du tampon en octets
+ * @param debut Position de départ pour la recherche
+ * @return Position de la séquence de sync, ou -1 si non trouvée
+ */
+int trouver_sync(const uint8_t* buffer, size_t taille, size_t debut) {
+    static const FonctionSync recherche = choisir_trouver_sync();
+    return recherche(buffer, taille, debut);
+}
+
+/**
+ * @brief trouver_sync() pour des tampons de taille quelconque
+ *
+ * Découpe la recherche en fenêtres de TAILLE_FENETRE_CARTE octets pour que
+ * les positions restent représentables par un int.
+ *
+ * @return Position de la séquence de sync, ou AUCUNE_POSITION
+ */
+size_t chercher_sync(const uint8_t* buffer, size_t taille, size_t debut) {
+    size_t pos = debut;
+    while (pos + 1 < taille) {
+        size_t fenetre = std::min(TAILLE_FENETRE_CARTE, taille - pos);
+        int idx = trouver_sync(buffer + pos, fenetre, 0);
+        if (idx >= 0) {
+            return pos + static_cast<size_t>(idx);
+        }
+        if (pos + fenetre >= taille) {
+            break;
+        }
+        pos += fenetre - 1;  // Une paire peut chevaucher deux fenêtres
+    }
+    return AUCUNE_POSITION;
+}
+
+/**
+ * @brief Vérifie si une trame est valide
+ * 
+ * Une trame est considérée valide si ses octets de synchronisation sont
+ * corrects. (0xAA et 0x55)
+ * 
+ * @param trame Pointeur vers la trame à vérifier
+ * @return true si la trame est valide, false sinon
+ */
+template <size_t Axes>
+bool trame_valide(const TrameAxes<Axes>* trame) {
+    return trame->sync1 == SYNC_H && trame->sync2 == SYNC_L;
+}
+
+/**
+ * @brief Vérifie les octets de synchronisation d'une trame vue en place
+ */
+bool trame_valide(const VueTrame& trame) {
+    return trame.sync1() == SYNC_H && trame.sync2() == SYNC_L;
+}
+
+// ============================================================================
+// Intégrité des trames, format v2 (--crc)
+// ============================================================================
+//
+// Une trame v2 est la trame v1 (39 octets, 45 pour le cobot) suivie du
+// CRC-32C (Castagnoli : polynôme réfléchi 0x82F63B78, valeur initiale et xor
+// final 0xFFFFFFFF) de ces octets, en little-endian. Une paire 0xAA 0x55 trouvée
+// dans du bruit n'a qu'une chance sur 2^32 de porter un CRC correct.
+//
+// Le CRC est calculé par l'instruction crc32 de SSE4.2 quand le processeur
+// l'offre, sinon par crc32c_tables() (protocole_telemetrie.h, « slicing-by-8 »),
+// celle qu'emploie le simulateur.
+
+#if defined(__x86_64__)
+/**
+ * @brief CRC-32C par l'instruction crc32 (SSE4.2), 8 octets par instruction
+ */
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(const uint8_t* donnees, size_t taille) {
+    uint64_t crc = 0xFFFFFFFFu;
+    while (taille >= 8) {
+        uint64_t mot;
+        std::memcpy(&mot, donnees, 8);
+        crc = _mm_crc32_u64(crc, mot);
+        donnees += 8;
+        taille -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+    while (taille-- > 0) {
+        crc32 = _mm_crc32_u8(crc32, *donnees++);
+    }
+    return crc32 ^ 0xFFFFFFFFu;
+}
+#endif
+
+using FonctionCrc = uint32_t (*)(const uint8_t*, size_t);
+
+/**
+ * @brief Choisit l'implémentation du CRC-32C selon le processeur
+ */
+FonctionCrc choisir_crc32c() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42;
+    }
+#endif
+    return crc32c_tables;
+}
+
+/**
+ * @brief CRC-32C d'un bloc d'octets (implémentation choisie au premier appel)
+ */
+uint32_t crc32c(const uint8_t* donnees, size_t taille) {
+    static const FonctionCrc calcul = choisir_crc32c();
+    return calcul(donnees, taille);
+}
+
+/**
+ * @brief Format des trames d'une capture, fixé au démarrage (--axes, --crc)
+ */
+struct FormatTrame {
+    size_t nb_axes = NB_AXES_BRAS;
+    bool crc = false;           // Format v2 : trames suivies d'un CRC-32C
+};
+
+/**
+ * @brief Vérifie le CRC qui suit une trame v2 de @p taille octets
+ */
+bool crc_valide(const VueTrame& trame, size_t taille) {
+    return crc32c(trame.octets, taille) == lire_u32_le(trame.octets + taille);
+}
+
+/**
+ * @brief Taille d'une trame sur le lien : v1, ou v2 avec CRC
+ */
+inline size_t taille_trame(const FormatTrame& format) {
+    return taille_trame_axes(format.nb_axes) + (format.crc ? TAILLE_CRC : 0);
+}
+
+/**
+ * @brief Trame synchronisée et, en format v2, de CRC correct
+ */
+inline bool trame_acceptee(const VueTrame& trame, const FormatTrame& format) {
+    return trame_valide(trame) &&
+           (!format.crc || crc_valide(trame, taille_trame_axes(format.nb_axes)));
+}
+
+// ============================================================================
+// Confirmation des sync (resynchronisation)
+// ============================================================================
+//
+// Un 0xAA 0x55 au milieu du bruit ou des données ferait décoder une fausse
+// trame puis sauter ses 39 octets, quitte à enjamber le début d'une vraie
+// trame. Un candidat n'est donc retenu que si une trame le suit : une paire
+// de sync juste après lui (cas courant, une comparaison), ou, s'il est suivi
+// de bruit, une paire à moins de FENETRE_RESYNC octets portant la séquence
+// suivante. La première paire de la fenêtre suffit dans le cas courant ;
+// sinon, le bruit pouvant lui-même contenir des paires, toute la fenêtre est
+// parcourue, et une trame perdue ou dupliquée juste après le candidat est
+// admise si la première paire est elle-même confirmée par celle qui la suit.
+// Ces deux recours supposent que le candidat ne recouvre pas une trame
+// confirmée : c'est le cas d'un faux sync placé juste avant une vraie trame.
+// Un candidat écarté ne compte que pour un octet de bruit et la recherche
+// reprend à l'octet suivant. La décision ne dépend que des octets lus : elle
+// est la même en flux, en fichier mappé et en parallèle.
+
+enum VerdictSync {
+    SYNC_CONFIRME,      // Trame retenue
+    SYNC_ECARTE,        // Faux sync : un octet de bruit
+    SYNC_INCOMPLET      // Octets suivants pas encore lus
 };
 
+// Bruit toléré entre une trame et la suivante (le simulateur en met au plus 10)
+const size_t FENETRE_RESYNC = 64;
+
+// Octets lus au plus au-delà d'une trame pour la confirmer (la trame suivante
+// et sa propre fenêtre comprises)
+const size_t MARGE_RESYNC = TAILLE_MAX_TRAME + 2 * FENETRE_RESYNC + 2;
+
+// Reste d'un tampon repris au début du suivant, au plus : une trame
+// incomplète (v2 comprise) ou en attente de confirmation
+const size_t TAILLE_MAX_RESTE = TAILLE_MAX_TRAME + MARGE_RESYNC;
+
+/**
+ * @brief Cherche la trame qui suit un candidat : sync accolé ou séquence suivante
+ * @param buffer Tampon de données
+ * @param taille Nombre d'octets valides dans le tampon
+ * @param debut Position du candidat (debut + pas <= taille)
+ * @param pas Taille d'une trame (voir taille_trame())
+ * @param fin Vrai si aucun octet ne suivra : la dernière trame est retenue
+ * @param fenetre_entiere Faux : seule la première paire du bruit est comparée
+ * @param premiere Reçoit la position de cette première paire (inchangée
+ *                 s'il n'y en a pas)
+ */
+VerdictSync chercher_suite(const uint8_t* buffer, size_t taille, size_t debut,
+                           size_t pas, bool fin, bool fenetre_entiere, size_t& premiere) {
+    size_t suite = debut + pas;
+    if (suite + 1 >= taille) {
+        return fin ? SYNC_CONFIRME : SYNC_INCOMPLET;
+    }
+    if (buffer[suite] == SYNC_H && buffer[suite + 1] == SYNC_L) {
+        return SYNC_CONFIRME;
+    }
+
+    // Du bruit suit : la prochaine trame doit porter la séquence suivante
+    uint8_t attendue = static_cast<uint8_t>(buffer[debut + 2] + 1);
+    for (size_t k = suite + 1; k < suite + FENETRE_RESYNC; k++) {
+        if (k + 2 >= taille) {
+            return fin ? SYNC_CONFIRME : SYNC_INCOMPLET;
+        }
+        if (buffer[k] == SYNC_H && buffer[k + 1] == SYNC_L) {
+            if (buffer[k + 2] == attendue) {
+                return SYNC_CONFIRME;
+            }
+            if (premiere == AUCUNE_POSITION) {
+                premiere = k;
+            }
+            if (!fenetre_entiere) {
+                return SYNC_ECARTE;
+            }
+        }
+    }
+    return SYNC_ECARTE;
+}
+
+/**
+ * @brief Confirme un candidat de sync par la trame qui le suit
+ * @param buffer Tampon de données
+ * @param taille Nombre d'octets valides dans le tampon
+ * @param debut Position du candidat (debut + pas <= taille)
+ * @param pas Taille d'une trame (voir taille_trame())
+ * @param fin Vrai si aucun octet ne suivra : la dernière trame est retenue
+ */
+VerdictSync confirmer_sync(const uint8_t* buffer, size_t taille, size_t debut,
+                           size_t pas, bool fin) {
+    size_t premiere = AUCUNE_POSITION;
+    VerdictSync verdict = chercher_suite(buffer, taille, debut, pas, fin, false, premiere);
+    if (verdict != SYNC_ECARTE) {
+        return verdict;
+    }
+
+    // Recours : le candidat ne doit recouvrir aucune trame confirmée
+    size_t ignoree = AUCUNE_POSITION;
+    for (size_t k = debut + 1; k + 1 < debut + pas; k++) {
+        if (buffer[k] == SYNC_H && buffer[k + 1] == SYNC_L) {
+            VerdictSync interne = chercher_suite(buffer, taille, k, pas, false, true, ignoree);
+            if (interne != SYNC_ECARTE) {
+                return interne == SYNC_CONFIRME || fin ? SYNC_ECARTE : SYNC_INCOMPLET;
+            }
+        }
+    }
+
+    // Paires de bruit avant la trame suivante
+    verdict = chercher_suite(buffer, taille, debut, pas, fin, true, ignoree);
+    if (verdict != SYNC_ECARTE || premiere == AUCUNE_POSITION) {
+        return verdict;
+    }
+
+    // Perte ou doublon : la paire suivante doit être elle-même une vraie trame
+    return chercher_suite(buffer, taille, premiere, pas, fin, false, ignoree);
+}
+
+
+// ============================================================================
+// Fonctions d'analyse
+// ============================================================================
+
+/**
+ * @brief Convertit un seuil en ampères en seuil entier en milliampères
+ *
+ * Pour un courant brut c (mA) : c / 1000 > seuil  <=>  c > floor(seuil * 1000).
+ * Le résultat est borné à [-1, 65535] : -1 signifie que tout courant est en
+ * alerte, 65535 qu'aucun ne peut l'être.
+ *
+ * @param seuil Seuil de courant en ampères
+ * @return Seuil en milliampères, à comparer strictement au courant brut
+ */
+int32_t seuil_en_milliamperes(float seuil) {
+    double milli = std::floor(static_cast<double>(seuil) * 1000.0);
+    if (!(milli >= 0.0)) {
+        return -1;
+    }
+    if (milli >= 65535.0) {
+        return 65535;
+    }
+    return static_cast<int32_t>(milli);
+}
+
+/**
+ * @brief Vérifie si un courant d'axe est en alerte
+ * @param courant Courant brut en milliampères
+ * @param seuil_ma Seuil converti une fois pour toutes (voir seuil_en_milliamperes())
+ * @return true si le courant dépasse le seuil
+ */
+inline bool est_en_alerte(uint16_t courant, int32_t seuil_ma) {
+    return courant > seuil_ma;
+}
+
+// ============================================================================
+// Traitement par lots (colonnes)
+// ============================================================================
+
+/**
+ * @brief Lot de trames décodées en colonnes (structure de tableaux)
+ *
+ * Chaque champ de chaque axe est rangé dans un tableau contigu de
+ * TAILLE_LOT valeurs : les seuils, min/max et conversions parcourent ainsi
+ * des données contiguës et sont vectorisés par le compilateur. Seules les
+ * nb_axes premières colonnes de chaque champ sont remplies.
+ */
+struct LotTrames {
+    size_t nb = 0;
+    size_t nb_axes = NB_AXES_BRAS;              // Fixé par qui remplit le lot
+    alignas(64) uint8_t sequence[TAILLE_LOT];
+    alignas(64) int16_t position[MAX_AXES][TAILLE_LOT];
+    alignas(64) int16_t vitesse[MAX_AXES][TAILLE_LOT];
+    alignas(64) uint16_t courant[MAX_AXES][TAILLE_LOT];
+    alignas(64) uint8_t alerte[TAILLE_LOT];     // Bit i : axe i en alerte
+};
+
+static_assert(MAX_AXES <= 8, "le masque d'alerte tient sur un octet");
+
+/**
+ * @brief Décode une trame valide de Axes axes à la suite du lot
+ *
+ * @param lot Lot non plein, de lot.nb_axes == Axes
+ * @param trame Vue sur la trame dans le tampon d'entrée
+ */
+template <size_t Axes>
+inline void decoder_dans_lot(LotTrames& lot, const VueTrame& trame) {
+    using D = DispositionTrame<Axes>;
+    size_t k = lot.nb++;
+    lot.sequence[k] = trame.octets[D::sequence];
+    for (size_t i = 0; i < Axes; i++) {
+        lot.position[i][k] = static_cast<int16_t>(lire_u16_le(trame.octets + D::position(i)));
+        lot.vitesse[i][k] = static_cast<int16_t>(lire_u16_le(trame.octets + D::vitesse(i)));
+        lot.courant[i][k] = lire_u16_le(trame.octets + D::courant(i));
+    }
+}
+
+/**
+ * @brief Masque où les bits des nb_axes axes sont à 1
+ */
+constexpr uint8_t masque_tous_axes(size_t nb_axes) {
+    return static_cast<uint8_t>((1u << nb_axes) - 1);
+}
+
+/**
+ * @brief Calcule le masque d'alerte de n trames (version de référence)
+ *
+ * @param courant Colonnes de courant brut (mA), une par axe
+ * @param n Nombre de trames
+ * @param seuil_ma Seuil en milliampères, dans [0, 65534]
+ * @param masque Sortie : bit i de masque[k] à 1 si l'axe i de la trame k dépasse le seuil
+ */
+template <size_t Axes>
+void masques_alerte_scalaire(const uint16_t courant[][TAILLE_LOT], size_t n,
+                             int32_t seuil_ma, uint8_t* masque) {
+    std::memset(masque, 0, n);
+    for (size_t i = 0; i < Axes; i++) {
+        for (size_t k = 0; k < n; k++) {
+            masque[k] |= static_cast<uint8_t>(est_en_alerte(courant[i][k], seuil_ma) << i);
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Les comparaisons 16 bits SSE2/AVX2 sont signées : en inversant le bit de
+// poids fort des deux opérandes, l'ordre non signé devient l'ordre signé.
+const int16_t BIAIS_NON_SIGNE = static_cast<int16_t>(0x8000);
+
+/**
+ * @brief Masque d'alerte SSE2 : 16 trames par itération et par axe
+ */
+template <size_t Axes>
+__attribute__((target("sse2")))
+void masques_alerte_sse2(const uint16_t courant[][TAILLE_LOT], size_t n,
+                         int32_t seuil_ma, uint8_t* masque) {
+    const __m128i biais = _mm_set1_epi16(BIAIS_NON_SIGNE);
+    const __m128i seuil = _mm_set1_epi16(static_cast<int16_t>(seuil_ma ^ 0x8000));
+
+    std::memset(masque, 0, n);
+    for (size_t i = 0; i < Axes; i++) {
+        const __m128i bit = _mm_set1_epi8(static_cast<char>(1u << i));
+        const uint16_t* c = courant[i];
+        size_t k = 0;
+
+        for (; k + 16 <= n; k += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + k));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + k + 8));
+            __m128i ga = _mm_cmpgt_epi16(_mm_xor_si128(a, biais), seuil);
+            __m128i gb = _mm_cmpgt_epi16(_mm_xor_si128(b, biais), seuil);
+            __m128i octets = _mm_and_si128(_mm_packs_epi16(ga, gb), bit);
+            __m128i* dest = reinterpret_cast<__m128i*>(masque + k);
+            _mm_storeu_si128(dest, _mm_or_si128(_mm_loadu_si128(dest), octets));
+        }
+        for (; k < n; k++) {
+            masque[k] |= static_cast<uint8_t>((c[k] > seuil_ma) << i);
+        }
+    }
+}
+
+/**
+ * @brief Masque d'alerte AVX2 : 32 trames par itération et par axe
+ */
+template <size_t Axes>
+__attribute__((target("avx2")))
+void masques_alerte_avx2(const uint16_t courant[][TAILLE_LOT], size_t n,
+                         int32_t seuil_ma, uint8_t* masque) {
+    const __m256i biais = _mm256_set1_epi16(BIAIS_NON_SIGNE);
+    const __m256i seuil = _mm256_set1_epi16(static_cast<int16_t>(seuil_ma ^ 0x8000));
+
+    std::memset(masque, 0, n);
+    for (size_t i = 0; i < Axes; i++) {
+        const __m256i bit = _mm256_set1_epi8(static_cast<char>(1u << i));
+        const uint16_t* c = courant[i];
+        size_t k = 0;
+
+        for (; k + 32 <= n; k += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + k));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + k + 16));
+            __m256i ga = _mm256_cmpgt_epi16(_mm256_xor_si256(a, biais), seuil);
+            __m256i gb = _mm256_cmpgt_epi16(_mm256_xor_si256(b, biais), seuil);
+            // packs travaille par moitiés de 128 bits : remettre les 4 quarts en ordre
+            __m256i octets = _mm256_permute4x64_epi64(_mm256_packs_epi16(ga, gb), 0xD8);
+            octets = _mm256_and_si256(octets, bit);
+            __m256i* dest = reinterpret_cast<__m256i*>(masque + k);
+            _mm256_storeu_si256(dest, _mm256_or_si256(_mm256_loadu_si256(dest), octets));
+        }
+        for (; k < n; k++) {
+            masque[k] |= static_cast<uint8_t>((c[k] > seuil_ma) << i);
+        }
+    }
+}
+
+#elif defined(__aarch64__)
+
+/**
+ * @brief Masque d'alerte NEON : 16 trames par itération et par axe
+ */
+template <size_t Axes>
+void masques_alerte_neon(const uint16_t courant[][TAILLE_LOT], size_t n,
+                         int32_t seuil_ma, uint8_t* masque) {
+    const uint16x8_t seuil = vdupq_n_u16(static_cast<uint16_t>(seuil_ma));
+
+    std::memset(masque, 0, n);
+    for (size_t i = 0; i < Axes; i++) {
+        const uint8x16_t bit = vdupq_n_u8(static_cast<uint8_t>(1u << i));
+        const uint16_t* c = courant[i];
+        size_t k = 0;
+
+        for (; k + 16 <= n; k += 16) {
+            uint16x8_t ga = vcgtq_u16(vld1q_u16(c + k), seuil);
+            uint16x8_t gb = vcgtq_u16(vld1q_u16(c + k + 8), seuil);
+            uint8x16_t octets = vandq_u8(vcombine_u8(vmovn_u16(ga), vmovn_u16(gb)), bit);
+            vst1q_u8(masque + k, vorrq_u8(vld1q_u8(masque + k), octets));
+        }
+        for (; k < n; k++) {
+            masque[k] |= static_cast<uint8_t>((c[k] > seuil_ma) << i);
+        }
+    }
+}
+
+#endif
+
+using FonctionMasques = void (*)(const uint16_t[][TAILLE_LOT], size_t, int32_t, uint8_t*);
+
+/**
+ * @brief Choisit la meilleure implémentation du masque d'alerte à Axes axes
+ */
+template <size_t Axes>
+FonctionMasques choisir_masques_alerte() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return masques_alerte_avx2<Axes>;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return masques_alerte_sse2<Axes>;
+    }
+#elif defined(__aarch64__)
+    return masques_alerte_neon<Axes>;
+#endif
+    return masques_alerte_scalaire<Axes>;
+}
+
+/**
+ * @brief Calcule, pour n trames, quels axes dépassent le seuil de courant
+ *
+ * Comparaison entière sur les milliampères bruts, sans conversion en
+ * flottant ; les Axes axes sont traités colonne par colonne avec des
+ * comparaisons 16 bits vectorielles.
+ *
+ * @param courant Colonnes de courant brut (mA), une par axe
+ * @param n Nombre de trames
+ * @param seuil_ma Seuil entier (voir seuil_en_milliamperes())
+ * @param masque Sortie : un octet par trame, bit i = axe i en alerte
+ */
+template <size_t Axes>
+void masques_alerte(const uint16_t courant[][TAILLE_LOT], size_t n,
+                    int32_t seuil_ma, uint8_t* masque) {
+    if (seuil_ma < 0) {
+        std::memset(masque, masque_tous_axes(Axes), n);
+        return;
+    }
+    if (seuil_ma >= 65535) {
+        std::memset(masque, 0, n);
+        return;
+    }
+    static const FonctionMasques calcul = choisir_masques_alerte<Axes>();
+    calcul(courant, n, seuil_ma, masque);
+}
+
+/**
+ * @brief Agrège les colonnes d'un axe d'un lot dans ses statistiques
+ *
+ * Sommes entières exactes sur le lot (boucle vectorisée), converties en
+ * agrégat partiel puis combinées au total par fusionner_axe().
+ */
+void accumuler_colonnes_axe(StatistiquesAxe& stats, const int16_t* position,
+                            const int16_t* vitesse, const uint16_t* courant, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    int16_t pos_min = INT16_MAX;
+    int16_t pos_max = INT16_MIN;
+    int32_t vit_max = 0;
+    int64_t somme_position = 0;
+    uint64_t somme_courant = 0;
+    uint64_t somme_carres = 0;
+    for (size_t k = 0; k < n; k++) {
+        int32_t v = vitesse[k];
+        uint32_t c = courant[k];
+        pos_min = std::min(pos_min, position[k]);
+        pos_max = std::max(pos_max, position[k]);
+        vit_max = std::max(vit_max, v < 0 ? -v : v);
+        somme_position += position[k];
+        somme_courant += c;
+        somme_carres += static_cast<uint64_t>(c * c);
+    }
+
+    // n * somme_carres - somme² est exact : n <= TAILLE_LOT, c < 2^16
+    double nd = static_cast<double>(n);
+    StatistiquesAxe partie;
+    partie.nb = n;
+    partie.position_min = pos_min;
+    partie.position_max = pos_max;
+    partie.vitesse_crete = static_cast<uint16_t>(vit_max);
+    partie.position_moyenne = static_cast<double>(somme_position) / nd;
+    partie.courant_moyen = static_cast<double>(somme_courant) / nd;
+    partie.courant_m2 = static_cast<double>(n * somme_carres - somme_courant * somme_courant) / nd;
+    fusionner_axe(stats, partie);
+}
+
+/**
+ * @brief Analyse toutes les trames d'un lot et met à jour les statistiques
+ *
+ * Séquence, agrégats par axe et alertes de chaque trame ; remplit le masque
+ * d'alerte lot.alerte.
+ *
+ * @param lot Lot décodé
+ * @param stats Statistiques à mettre à jour
+ * @param seuil_ma Seuil en milliampères (voir seuil_en_milliamperes())
+ */
+template <size_t Axes>
+void analyser_lot(LotTrames& lot, Statistiques& stats, int32_t seuil_ma) {
+    const size_t n = lot.nb;
+
+    uint8_t seq_min = stats.sequence_min;
+    uint8_t seq_max = stats.sequence_max;
+    for (size_t k = 0; k < n; k++) {
+        seq_min = std::min(seq_min, lot.sequence[k]);
+        seq_max = std::max(seq_max, lot.sequence[k]);
+    }
+    stats.sequence_min = seq_min;
+    stats.sequence_max = seq_max;
+
+    for (size_t k = 0; k < n; k++) {
+        suivre_sequence(stats.suivi, lot.sequence[k]);
+    }
+
+    for (size_t i = 0; i < Axes; i++) {
+        accumuler_colonnes_axe(stats.axes[i], lot.position[i], lot.vitesse[i],
+                               lot.courant[i], n);
+    }
+
+    masques_alerte<Axes>(lot.courant, n, seuil_ma, lot.alerte);
+
+    size_t alertes = 0;
+    for (size_t k = 0; k < n; k++) {
+        alertes += lot.alerte[k] != 0;
+    }
+
+    stats.trames_valides += n;
+    stats.trames_alerte += alertes;
+}
+
+/**
+ * @brief Analyse un lot selon son nombre d'axes (un aiguillage par lot)
+ */
+void analyser_lot(LotTrames& lot, Statistiques& stats, int32_t seuil_ma) {
+    if (lot.nb_axes == NB_AXES_COBOT) {
+        analyser_lot<NB_AXES_COBOT>(lot, stats, seuil_ma);
+    } else {
+        analyser_lot<NB_AXES_BRAS>(lot, stats, seuil_ma);
+    }
+}
+
+// ============================================================================
+// Files SPSC entre étages (pipeline du mode flux)
+// ============================================================================
+//
+// Deux étages voisins sont reliés par une Liaison : deux files sans verrou à
+// un seul producteur et un seul consommateur, l'une pour les morceaux pleins
+// (vers l'aval), l'autre pour les morceaux vides (retour vers l'amont). Tous
+// les morceaux sont alloués au démarrage. Un étage qui ne trouve pas de
+// morceau attend (contre-pression) ; ces attentes sont comptées et chronométrées.
+// L'attente cède d'abord le cœur quelques fois, puis s'endort sur un futex
+// que le producteur réveille : un étage inactif (flux temps réel lent) ne
+// consomme rien, et le producteur ne fait un appel système que si son
+// consommateur dort.
+
+const size_t NB_MORCEAUX = 16;      // Morceaux par liaison
+const unsigned NB_ESSAIS_ACTIFS = 64;   // Avant de s'endormir
+
+/**
+ * @brief File circulaire sans verrou, un producteur et un consommateur
+ *
+ * Les index croissent sans borne ; tete et queue sont sur des lignes de
+ * cache séparées pour que les deux fils ne se les disputent pas.
+ */
+template <typename T, size_t N>
+struct FileSpsc {
+    static_assert((N & (N - 1)) == 0, "N doit être une puissance de 2");
+    alignas(64) std::atomic<size_t> tete{0};    // Prochaine écriture (producteur)
+    alignas(64) std::atomic<size_t> queue{0};   // Prochaine lecture (consommateur)
+    alignas(64) std::atomic<uint32_t> endormi{0};   // 1 : consommateur sur le futex
+    alignas(64) T cases[N];
+};
+
+/**
+ * @brief Dort tant que @p mot vaut @p valeur (futex(2), réveils parasites possibles)
+ */
+inline void attendre_mot(std::atomic<uint32_t>& mot, uint32_t valeur) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&mot), FUTEX_WAIT_PRIVATE, valeur,
+            nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Réveille le fil endormi sur @p mot
+ */
+inline void reveiller_mot(std::atomic<uint32_t>& mot) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&mot), FUTEX_WAKE_PRIVATE, 1,
+            nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Ajoute un élément (producteur seulement)
+ * @return false si la file est pleine
+ */
+template <typename T, size_t N>
+bool deposer(FileSpsc<T, N>& file, const T& valeur) {
+    size_t tete = file.tete.load(std::memory_order_relaxed);
+    if (tete - file.queue.load(std::memory_order_acquire) == N) {
+        return false;
+    }
+    file.cases[tete & (N - 1)] = valeur;
+    file.tete.store(tete + 1, std::memory_order_release);
+
+    // Ordonne la publication avant la lecture de endormi (voir attendre_element())
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (file.endormi.load(std::memory_order_relaxed) != 0) {
+        file.endormi.store(0, std::memory_order_relaxed);
+        reveiller_mot(file.endormi);
+    }
+    return true;
+}
+
+/**
+ * @brief Retire l'élément le plus ancien (consommateur seulement)
+ * @return false si la file est vide
+ */
+template <typename T, size_t N>
+bool retirer(FileSpsc<T, N>& file, T& valeur) {
+    size_t queue = file.queue.load(std::memory_order_relaxed);
+    if (queue == file.tete.load(std::memory_order_acquire)) {
+        return false;
+    }
+    valeur = file.cases[queue & (N - 1)];
+    file.queue.store(queue + 1, std::memory_order_release);
+    return true;
+}
+
+// Morceau de données échangé entre étages ; taille 0 : fin du flux
+struct Morceau {
+    char* donnees = nullptr;
+    size_t taille = 0;
+};
+
+// Attentes d'un côté d'une liaison
+struct Attentes {
+    uint64_t nb = 0;
+    uint64_t ns = 0;
+};
+
+struct Liaison {
+    // Capacité double : les NB_MORCEAUX morceaux plus la marque de fin
+    FileSpsc<Morceau, 2 * NB_MORCEAUX> pleins;
+    FileSpsc<Morceau, 2 * NB_MORCEAUX> libres;
+    std::unique_ptr<char[]> memoire;
+    size_t taille_morceau = 0;
+    size_t marge = 0;           // Octets libres devant chaque morceau
+    Attentes producteur;        // Aucun morceau libre : l'aval ne suit pas
+    Attentes consommateur;      // Aucun morceau plein : l'amont n'a rien produit
+    size_t occupation_max = 0;  // Morceaux pleins en attente, au plus
+};
+
+/**
+ * @brief Alloue les morceaux d'une liaison et les place dans la file des libres
+ * @param marge Octets réservés devant chaque morceau, où le consommateur peut
+ *              recopier le reste du morceau précédent
+ */
+void preparer_liaison(Liaison& liaison, size_t taille_morceau, size_t marge = 0) {
+    liaison.taille_morceau = taille_morceau;
+    liaison.marge = marge;
+    liaison.memoire.reset(new char[NB_MORCEAUX * (marge + taille_morceau)]);
+    for (size_t k = 0; k < NB_MORCEAUX; k++) {
+        char* morceau = liaison.memoire.get() + k * (marge + taille_morceau) + marge;
+        deposer(liaison.libres, Morceau{morceau, 0});
+    }
+}
+
+/**
+ * @brief Retire un élément, en attendant s'il le faut
+ *
+ * NB_ESSAIS_ACTIFS essais en cédant le cœur, puis sommeil sur file.endormi.
+ * Le consommateur publie endormi avant de revérifier la file, le producteur
+ * publie l'élément avant de lire endormi (barrières seq_cst des deux côtés) :
+ * l'un des deux voit toujours l'écriture de l'autre, aucun réveil n'est perdu.
+ */
+template <typename T, size_t N>
+T attendre_element(FileSpsc<T, N>& file, Attentes& attentes) {
+    T valeur;
+    if (retirer(file, valeur)) {
+        return valeur;
+    }
+    auto debut = std::chrono::steady_clock::now();
+    for (unsigned essai = 0; !retirer(file, valeur); essai++) {
+        if (essai < NB_ESSAIS_ACTIFS) {
+            std::this_thread::yield();
+            continue;
+        }
+        file.endormi.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (retirer(file, valeur)) {
+            file.endormi.store(0, std::memory_order_relaxed);
+            break;
+        }
+        attendre_mot(file.endormi, 1);
+    }
+    attentes.nb++;
+    attentes.ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - debut).count());
+    return valeur;
+}
+
+/**
+ * @brief Prend un morceau vide (producteur)
+ */
+Morceau prendre_libre(Liaison& liaison) {
+    return attendre_element(liaison.libres, liaison.producteur);
+}
+
+/**
+ * @brief Transmet un morceau plein, ou la fin du flux (producteur)
+ */
+void envoyer_morceau(Liaison& liaison, const Morceau& morceau) {
+    while (!deposer(liaison.pleins, morceau)) {
+        std::this_thread::yield();    // Impossible en pratique (capacité double)
+    }
+    size_t occupation = liaison.pleins.tete.load(std::memory_order_relaxed) -
+                        liaison.pleins.queue.load(std::memory_order_relaxed);
+    liaison.occupation_max = std::max(liaison.occupation_max, occupation);
+}
+
+/**
+ * @brief Attend le prochain morceau plein (consommateur)
+ */
+Morceau recevoir_morceau(Liaison& liaison) {
+    return attendre_element(liaison.pleins, liaison.consommateur);
+}
+
+/**
+ * @brief Rend un morceau consommé à son producteur (consommateur)
+ */
+void rendre_morceau(Liaison& liaison, Morceau morceau) {
+    morceau.taille = 0;
+    while (!deposer(liaison.libres, morceau)) {
+        std::this_thread::yield();
+    }
+}
+
+// ============================================================================
+// Métriques de fonctionnement (--metrics)
+// ============================================================================
+//
+// Pour savoir en production si l'analyseur attend son entrée ou s'il est
+// limité par l'analyse ou la mise en forme, chaque fil tient ses propres
+// compteurs sur une ligne de cache à lui : octets parcourus, sync écartés,
+// trames décodées, alertes, et temps passé à lire, à traiter les trames et à
+// mettre en forme le rapport. Les compteurs sont mis à jour une fois par
+// tampon ou par lot, jamais par trame (seuls les sync écartés, rares, sont
+// comptés un à un) ; un fil dédié en écrit le cumul toutes les
+// --metrics-every secondes.
+//
+// Sans ANALYSEUR_METRIQUES (make METRIQUES=1), les fonctions de cette section
+// sont vides : compteurs et lectures d'horloge disparaissent à la compilation.
+
+#ifndef ANALYSEUR_METRIQUES
+#define ANALYSEUR_METRIQUES 0
+#endif
+
+enum CompteurMetrique {
+    METRIQUE_OCTETS,            // Octets parcourus par la recherche de sync
+    METRIQUE_SYNC_ECARTES,      // Sync non confirmés ou CRC faux
+    METRIQUE_TRAMES,            // Trames décodées
+    METRIQUE_ALERTES,           // Trames avec au moins un axe en alerte
+    METRIQUE_NS_LECTURE,        // Dans read(2)
+    METRIQUE_NS_TRAITEMENT,     // Sync, décodage, analyse et rapport
+    METRIQUE_NS_RAPPORT,        // Mise en forme du rapport (part du traitement)
+    NB_METRIQUES
+};
+
+const size_t MAX_FILS_METRIQUES = 64;   // Au-delà, les fils partagent le dernier bloc
+const double PERIODE_METRIQUES_S = 1.0; // Défaut de --metrics-every
+
+inline uint64_t horloge_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if ANALYSEUR_METRIQUES
+
+/**
+ * @brief Compteurs d'un fil, seuls sur leur ligne de cache
+ *
+ * Seul le fil propriétaire les incrémente ; le fil d'écriture les lit.
+ */
+struct alignas(64) CompteursFil {
+    std::atomic<uint64_t> valeurs[NB_METRIQUES];
+    std::atomic<const char*> role{"fil"};
+};
+
+CompteursFil compteurs_fils[MAX_FILS_METRIQUES];
+std::atomic<size_t> nb_fils_metriques{0};
+thread_local CompteursFil* compteurs_du_fil = nullptr;
+
+/**
+ * @brief Attribue au fil appelant ses compteurs, en nommant son rôle
+ */
+inline void declarer_fil_metriques(const char* role) {
+    size_t k = nb_fils_metriques.fetch_add(1, std::memory_order_relaxed);
+    compteurs_du_fil = &compteurs_fils[std::min(k, MAX_FILS_METRIQUES - 1)];
+    compteurs_du_fil->role.store(role, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Ajoute @p valeur à un compteur du fil appelant
+ */
+inline void compter(CompteurMetrique compteur, uint64_t valeur) {
+    if (compteurs_du_fil == nullptr) {
+        declarer_fil_metriques("fil");
+    }
+    compteurs_du_fil->valeurs[compteur].fetch_add(valeur, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Début d'une mesure de durée (voir compter_duree())
+ */
+inline uint64_t debut_mesure() {
+    return horloge_ns();
+}
+
+/**
+ * @brief Ajoute à un compteur de temps la durée écoulée depuis @p debut
+ */
+inline void compter_duree(CompteurMetrique compteur, uint64_t debut) {
+    compter(compteur, horloge_ns() - debut);
+}
+
+#else
+
+inline void declarer_fil_metriques(const char*) {}
+inline void compter(CompteurMetrique, uint64_t) {}
+inline uint64_t debut_mesure() { return 0; }
+inline void compter_duree(CompteurMetrique, uint64_t) {}
+
+#endif
+
+/**
+ * @brief Fil qui écrit périodiquement les métriques
+ *
+ * destination "-" : une ligne de cumul sur stderr par période. Sinon, un
+ * fichier texte au format d'exposition Prometheus (un échantillon par fil),
+ * réécrit en entier à chaque période puis renommé, pour qu'un collecteur ne
+ * lise jamais un fichier à moitié écrit.
+ */
+struct DiffuseurMetriques {
+    std::string destination;
+    double periode_s = PERIODE_METRIQUES_S;
+    uint64_t debut_ns = 0;
+    std::thread fil;
+    std::mutex verrou;
+    std::condition_variable reveil;
+    bool arret = false;
+
+    ~DiffuseurMetriques();
+};
+
+#if ANALYSEUR_METRIQUES
+
+/**
+ * @brief Écrit l'état de tous les compteurs dans la destination
+ */
+void ecrire_metriques(const DiffuseurMetriques& diffuseur) {
+    const size_t nb = std::min(nb_fils_metriques.load(std::memory_order_relaxed),
+                               MAX_FILS_METRIQUES);
+    uint64_t valeurs[MAX_FILS_METRIQUES][NB_METRIQUES];
+    uint64_t total[NB_METRIQUES] = {};
+    for (size_t f = 0; f < nb; f++) {
+        for (size_t m = 0; m < NB_METRIQUES; m++) {
+            valeurs[f][m] = compteurs_fils[f].valeurs[m].load(std::memory_order_relaxed);
+            total[m] += valeurs[f][m];
+        }
+    }
+    // Le décodage est le traitement hors mise en forme du rapport
+    auto secondes_decodage = [](const uint64_t* v) {
+        uint64_t ns = v[METRIQUE_NS_TRAITEMENT] - std::min(v[METRIQUE_NS_TRAITEMENT],
+                                                           v[METRIQUE_NS_RAPPORT]);
+        return static_cast<double>(ns) / 1e9;
+    };
+    auto secondes = [](uint64_t ns) { return static_cast<double>(ns) / 1e9; };
+
+    std::ostringstream texte;
+    texte << std::fixed << std::setprecision(3);
+    if (diffuseur.destination == "-") {
+        texte << "Métriques t=" << secondes(horloge_ns() - diffuseur.debut_ns)
+              << " s : octets " << total[METRIQUE_OCTETS]
+              << " | sync écartés " << total[METRIQUE_SYNC_ECARTES]
+              << " | trames " << total[METRIQUE_TRAMES]
+              << " | alertes " << total[METRIQUE_ALERTES]
+              << " | lecture " << secondes(total[METRIQUE_NS_LECTURE])
+              << " s | décodage " << secondes_decodage(total)
+              << " s | rapport " << secondes(total[METRIQUE_NS_RAPPORT]) << " s\n";
+        std::cerr << texte.str();
+        return;
+    }
+
+    struct Serie { const char* nom; const char* aide; };
+    const Serie compteurs[] = {
+        {"analyseur_octets_total", "Octets parcourus par la recherche de sync"},
+        {"analyseur_sync_ecartes_total", "Sync non confirmés ou de CRC faux"},
+        {"analyseur_trames_total", "Trames décodées"},
+        {"analyseur_alertes_total", "Trames avec au moins un axe en alerte"},
+    };
+    for (size_t m = 0; m < 4; m++) {
+        texte << "# HELP " << compteurs[m].nom << " " << compteurs[m].aide << "\n"
+              << "# TYPE " << compteurs[m].nom << " counter\n";
+        for (size_t f = 0; f < nb; f++) {
+            texte << compteurs[m].nom << "{fil=\"" << f << "\",role=\""
+                  << compteurs_fils[f].role.load(std::memory_order_relaxed) << "\"} "
+                  << valeurs[f][m] << "\n";
+        }
+    }
+    texte << "# HELP analyseur_secondes_total Temps passé par étape\n"
+          << "# TYPE analyseur_secondes_total counter\n";
+    for (size_t f = 0; f < nb; f++) {
+        const char* role = compteurs_fils[f].role.load(std::memory_order_relaxed);
+        auto ligne = [&](const char* etape, double s) {
+            texte << "analyseur_secondes_total{fil=\"" << f << "\",role=\"" << role
+                  << "\",etape=\"" << etape << "\"} " << std::setprecision(6) << s << "\n";
+        };
+        ligne("lecture", secondes(valeurs[f][METRIQUE_NS_LECTURE]));
+        ligne("decodage", secondes_decodage(valeurs[f]));
+        ligne("rapport", secondes(valeurs[f][METRIQUE_NS_RAPPORT]));
+    }
+
+    const std::string temporaire = diffuseur.destination + ".tmp";
+    std::ofstream sortie(temporaire);
+    const std::string octets = texte.str();
+    sortie.write(octets.data(), static_cast<std::streamsize>(octets.size()));
+    sortie.close();
+    if (!sortie || std::rename(temporaire.c_str(), diffuseur.destination.c_str()) != 0) {
+        std::cerr << "Note: métriques non écrites (" << diffuseur.destination << ")\n";
+    }
+}
+
+/**
+ * @brief Démarre le fil d'écriture des métriques
+ */
+void demarrer_metriques(DiffuseurMetriques& diffuseur) {
+    diffuseur.debut_ns = horloge_ns();
+    DiffuseurMetriques* d = &diffuseur;
+    diffuseur.fil = std::thread([d]() {
+        std::unique_lock<std::mutex> garde(d->verrou);
+        auto periode = std::chrono::duration<double>(d->periode_s);
+        while (!d->reveil.wait_for(garde, periode, [d]() { return d->arret; })) {
+            ecrire_metriques(*d);
+        }
+    });
+}
+
+/**
+ * @brief Arrête le fil d'écriture et écrit le dernier état des compteurs
+ */
+void arreter_metriques(DiffuseurMetriques& diffuseur) {
+    if (!diffuseur.fil.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> garde(diffuseur.verrou);
+        diffuseur.arret = true;
+    }
+    diffuseur.reveil.notify_one();
+    diffuseur.fil.join();
+    ecrire_metriques(diffuseur);
+}
+
+#else
+
+inline void demarrer_metriques(DiffuseurMetriques&) {}
+inline void arreter_metriques(DiffuseurMetriques&) {}
+
+#endif
+
+DiffuseurMetriques::~DiffuseurMetriques() {
+    arreter_metriques(*this);
+}
+
+// ============================================================================
+// Contrôle des allocations (make ALLOCATIONS=1)
+// ============================================================================
+//
+// Tous les tampons du parcours sont alloués une fois pour la durée de
+// l'analyse et réutilisés : bloc de lecture (LecteurFlux), morceaux des
+// liaisons du pipeline, lot décodé (LotTrames), texte du rapport
+// (TamponSortie), bloc et index du fichier colonnaire. Une fois le parcours
+// commencé, le tas n'est plus sollicité, quelle que soit la durée du flux.
+//
+// Compilé avec ANALYSEUR_CONTROLE_ALLOCATIONS, operator new compte les
+// allocations faites par un fil en régime établi (RegimeAllocations) ; en fin
+// d'analyse, verifier_allocations() arrête le programme s'il y en a eu une.
+// Sans cette option, RegimeAllocations est vide.
+
+#ifndef ANALYSEUR_CONTROLE_ALLOCATIONS
+#define ANALYSEUR_CONTROLE_ALLOCATIONS 0
+#endif
+
+#if ANALYSEUR_CONTROLE_ALLOCATIONS
+
+std::atomic<uint64_t> allocations_en_regime{0};
+thread_local bool fil_en_regime = false;
+
+void* operator new(size_t taille) {
+    if (fil_en_regime) {
+        allocations_en_regime.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(taille != 0 ? taille : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t taille) {
+    return operator new(taille);
+}
+
+// Hors ligne : une fois inlinée, la paire new/free passe pour mal appariée
+// aux yeux de -Wmismatched-new-delete
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+/**
+ * @brief Marque le fil appelant en régime établi (ou hors régime) le temps
+ * de la portée
+ */
+struct RegimeAllocations {
+    bool precedent;
+    explicit RegimeAllocations(bool en_regime = true) : precedent(fil_en_regime) {
+        fil_en_regime = en_regime;
+    }
+    ~RegimeAllocations() { fil_en_regime = precedent; }
+};
+
+/**
+ * @brief Arrête le programme si une allocation a eu lieu en régime établi
+ */
+void verifier_allocations() {
+    uint64_t n = allocations_en_regime.load(std::memory_order_relaxed);
+    if (n != 0) {
+        std::cerr << "Erreur: " << n << " allocation(s) sur le tas en régime établi\n";
+        std::abort();
+    }
+}
+
+#else
+
+struct RegimeAllocations {
+    explicit RegimeAllocations(bool = true) {}
+};
+
+inline void verifier_allocations() {}
+
+#endif
+
+// ============================================================================
+// Fonctions d'entrée/sortie
+// ============================================================================
+
+/**
+ * @brief Lecteur par blocs à mémoire constante (fichier ou stdin)
+ *
+ * Les octets sont lus par read(2) en blocs de TAILLE_BLOC_LECTURE dans un
+ * tampon de taille fixe. Les octets non consommés à la fin d'un bloc (trame
+ * à cheval sur deux lectures) sont ramenés au début du tampon avant la
+ * lecture suivante, ce qui borne la mémoire quelle que soit la durée du flux.
+ */
+struct LecteurFlux {
+    int fd = -1;
+    bool proprietaire = false;      // true si fd doit être fermé
+    bool datagrammes = false;       // Socket UDP, lu par recvmmsg()
+    bool fin_datagrammes = false;   // Datagramme vide reçu, ou silence : fin du flux
+    bool recu = false;              // UDP : au moins un datagramme de données reçu
+    int inactivite_ms = 0;          // UDP : silence qui termine le flux (0 : aucun)
+    std::chrono::steady_clock::time_point derniere_reception;
+    std::vector<uint8_t> tampon;
+    size_t taille = 0;              // Octets valides au début du tampon
+};
+
+/**
+ * @brief Ouvre une entrée réseau en écoute
+ *
+ * "udp:[hôte:]port" reçoit des datagrammes d'une ou plusieurs trames entières,
+ * un datagramme vide ou lecteur.inactivite_ms sans datagramme marquant la fin
+ * du flux (voir lire_datagrammes()) ; "tcp:[hôte:]port" attend une
+ * connexion et la lit comme un pipe (resynchronisation par trouver_sync()).
+ * Le tampon de réception est agrandi à TAILLE_TAMPON_SOCKET pour absorber
+ * les rafales pendant que l'analyse tourne.
+ *
+ * @param lecteur Lecteur à initialiser (fd seulement, inactivite_ms déjà fixé)
+ * @param source Adresse d'écoute, voir est_adresse_reseau()
+ * @return true si la socket est prête à être lue
+ */
+bool ouvrir_socket(LecteurFlux& lecteur, const std::string& source) {
+    const AdresseReseau adresse = decouper_adresse(source);
+    const bool udp = adresse.udp;
+
+    addrinfo indications = {};
+    indications.ai_family = AF_UNSPEC;
+    indications.ai_socktype = udp ? SOCK_DGRAM : SOCK_STREAM;
+    indications.ai_flags = AI_PASSIVE;
+    addrinfo* resultats = nullptr;
+    int code = getaddrinfo(adresse.hote.empty() ? nullptr : adresse.hote.c_str(),
+                           adresse.port.c_str(), &indications, &resultats);
+    if (code != 0) {
+        std::cerr << "Erreur : adresse " << source << " invalide (" << gai_strerror(code) << ")\n";
+        return false;
+    }
+
+    int fd = -1;
+    for (addrinfo* r = resultats; r != nullptr && fd < 0; r = r->ai_next) {
+        fd = socket(r->ai_family, r->ai_socktype | SOCK_CLOEXEC, r->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int oui = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &oui, sizeof(oui));
+        // SO_RCVBUFFORCE dépasse net.core.rmem_max, mais exige CAP_NET_ADMIN
+        int taille = TAILLE_TAMPON_SOCKET;
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &taille, sizeof(taille)) != 0) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &taille, sizeof(taille));
+        }
+        if (bind(fd, r->ai_addr, r->ai_addrlen) != 0 || (!udp && listen(fd, 1) != 0)) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(resultats);
+    if (fd < 0) {
+        std::cerr << "Erreur : impossible d'écouter sur " << source
+                  << " (" << std::strerror(errno) << ")\n";
+        return false;
+    }
+
+    // Le noyau rapporte le double de la taille accordée
+    int accordee = 0;
+    socklen_t longueur = sizeof(accordee);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &accordee, &longueur) == 0 &&
+        accordee < TAILLE_TAMPON_SOCKET) {
+        std::cerr << "Note: tampon de réception limité à " << accordee / 2 / 1024
+                  << " Kio (voir net.core.rmem_max)\n";
+    }
+
+    if (!udp) {
+        std::cerr << "En attente d'une connexion TCP sur " << source << "...\n";
+        int connexion;
+        do {
+            connexion = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        } while (connexion < 0 && errno == EINTR);
+        int erreur = errno;
+        close(fd);
+        if (connexion < 0) {
+            std::cerr << "Erreur : connexion refusée (" << std::strerror(erreur) << ")\n";
+            return false;
+        }
+        fd = connexion;
+    }
+
+    lecteur.fd = fd;
+    lecteur.datagrammes = udp;
+    lecteur.fin_datagrammes = false;
+    lecteur.recu = false;
+    return true;
+}
+
+/**
+ * @brief Ouvre la source de données
+ * @param lecteur Lecteur à initialiser
+ * @param source Nom du fichier, "-" pour stdin, ou entrée réseau
+ *               (udp:[hôte:]port, tcp:[hôte:]port)
+ * @return true si la source est ouverte
+ */
+bool ouvrir_flux(LecteurFlux& lecteur, const std::string& source) {
+    if (est_adresse_reseau(source)) {
+        if (!ouvrir_socket(lecteur, source)) {
+            return false;
+        }
+        lecteur.proprietaire = true;
+    } else if (source == "-") {
+        lecteur.fd = STDIN_FILENO;
+        lecteur.proprietaire = false;
+    } else {
+        lecteur.fd = open(source.c_str(), O_RDONLY);
+        if (lecteur.fd < 0) {
+            std::cerr << "Erreur : impossible d'ouvrir le fichier " << source
+                      << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        lecteur.proprietaire = true;
+    }
+
+    // Un bloc complet + le reste du bloc précédent
+    lecteur.tampon.assign(TAILLE_MAX_RESTE + TAILLE_BLOC_LECTURE, 0);
+    lecteur.taille = 0;
+    return true;
+}
+
+/**
+ * @brief Un read(2) d'au plus @p capacite octets, repris sur EINTR
+ * @param lus Nombre d'octets lus (si true)
+ * @return false à la fin du flux ou sur erreur de lecture
+ */
+bool lire_dans(int fd, void* dest, size_t capacite, size_t& lus) {
+    for (;;) {
+        uint64_t debut = debut_mesure();
+        ssize_t n = read(fd, dest, capacite);
+        compter_duree(METRIQUE_NS_LECTURE, debut);
+        if (n > 0) {
+            lus = static_cast<size_t>(n);
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            std::cerr << "Erreur de lecture : " << std::strerror(errno) << "\n";
+        }
+        return false;
+    }
+}
+
+/**
+ * @brief Millisecondes de silence restantes avant la fin d'un flux UDP
+ * @return -1 si le flux ne peut pas finir par inactivité (pas d'UDP, pas de
+ *         délai, ou aucune donnée encore reçue), 0 si le délai est écoulé
+ */
+int delai_inactivite(const LecteurFlux& lecteur) {
+    if (!lecteur.datagrammes || lecteur.inactivite_ms <= 0 || !lecteur.recu ||
+        lecteur.fin_datagrammes) {
+        return -1;
+    }
+    auto ecoule = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - lecteur.derniere_reception).count();
+    return static_cast<int>(std::max<int64_t>(0, lecteur.inactivite_ms - ecoule));
+}
+
+/**
+ * @brief Termine un flux UDP resté silencieux inactivite_ms
+ */
+void constater_inactivite(LecteurFlux& lecteur) {
+    std::cerr << "Note: aucun datagramme depuis " << lecteur.inactivite_ms
+              << " ms, fin du flux supposée (marque de fin perdue ?)\n";
+    lecteur.fin_datagrammes = true;
+}
+
+/**
+ * @brief Reçoit d'un coup les datagrammes en attente (recvmmsg), bout à bout
+ *
+ * Chaque datagramme est reçu dans sa propre case de TAILLE_MAX_DATAGRAMME
+ * octets de @p dest, puis ramené à la suite du précédent : le bloc obtenu se
+ * lit comme un flux. L'appel attend le premier datagramme seulement.
+ *
+ * Un datagramme vide n'est pris pour la fin du flux qu'après des données (le
+ * simulateur en envoie plusieurs ; un reste d'un envoi précédent est ignoré).
+ * Une fois des données reçues, SO_RCVTIMEO arrête aussi le flux après
+ * lecteur.inactivite_ms de silence, au cas où toutes les marques de fin se
+ * seraient perdues.
+ *
+ * @param lecteur Lecteur UDP (fin_datagrammes est mis à jour)
+ * @param lus Nombre d'octets reçus (si true)
+ * @return false à la fin du flux (datagramme vide, silence) ou sur erreur
+ */
+bool lire_datagrammes(LecteurFlux& lecteur, uint8_t* dest, size_t capacite, size_t& lus) {
+    if (lecteur.fin_datagrammes) {
+        return false;
+    }
+    mmsghdr messages[NB_MAX_DATAGRAMMES];
+    iovec cases[NB_MAX_DATAGRAMMES];
+    const size_t nb_cases = std::min(NB_MAX_DATAGRAMMES, capacite / TAILLE_MAX_DATAGRAMME);
+
+    size_t total = 0;
+    while (total == 0 && !lecteur.fin_datagrammes) {
+        for (size_t k = 0; k < nb_cases; k++) {
+            cases[k].iov_base = dest + k * TAILLE_MAX_DATAGRAMME;
+            cases[k].iov_len = TAILLE_MAX_DATAGRAMME;
+            messages[k] = mmsghdr();
+            messages[k].msg_hdr.msg_iov = &cases[k];
+            messages[k].msg_hdr.msg_iovlen = 1;
+        }
+
+        int n;
+        for (;;) {
+            uint64_t debut = debut_mesure();
+            n = recvmmsg(lecteur.fd, messages, static_cast<unsigned>(nb_cases), MSG_WAITFORONE,
+                         nullptr);
+            compter_duree(METRIQUE_NS_LECTURE, debut);
+            if (n >= 0 || errno != EINTR) {
+                break;
+            }
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && lecteur.recu) {
+            constater_inactivite(lecteur);
+            return false;
+        }
+        if (n < 0) {
+            std::cerr << "Erreur de réception : " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        for (int k = 0; k < n; k++) {
+            size_t longueur = messages[k].msg_len;
+            if (longueur == 0) {
+                if (lecteur.recu) {
+                    lecteur.fin_datagrammes = true;     // Les suivants sont ignorés
+                    break;
+                }
+                continue;
+            }
+            if (messages[k].msg_hdr.msg_flags & MSG_TRUNC) {
+                std::cerr << "Note: datagramme tronqué à " << TAILLE_MAX_DATAGRAMME << " octets\n";
+            }
+            std::memmove(dest + total, cases[k].iov_base, longueur);
+            total += longueur;
+        }
+    }
+
+    if (total > 0 && !lecteur.recu && lecteur.inactivite_ms > 0) {
+        // Le flux a commencé : le silence compte désormais
+        timeval delai;
+        delai.tv_sec = lecteur.inactivite_ms / 1000;
+        delai.tv_usec = (lecteur.inactivite_ms % 1000) * 1000;
+        setsockopt(lecteur.fd, SOL_SOCKET, SO_RCVTIMEO, &delai, sizeof(delai));
+    }
+    lecteur.recu = lecteur.recu || total > 0;
+    lecteur.derniere_reception = std::chrono::steady_clock::now();
+    lus = total;
+    return total > 0;
+}
+
+/**
+ * @brief Lit le prochain morceau de la source (read(2), ou recvmmsg() en UDP)
+ */
+bool lire_entree(LecteurFlux& lecteur, uint8_t* dest, size_t capacite, size_t& lus) {
+    if (lecteur.datagrammes) {
+        return lire_datagrammes(lecteur, dest, capacite, lus);
+    }
+    return lire_dans(lecteur.fd, dest, capacite, lus);
+}
+
+/**
+ * @brief Lit le prochain bloc à la suite des octets déjà présents
+ *
+ * L'appel bloque jusqu'à ce que des données soient disponibles, mais rend
+ * la main dès qu'un read(2) retourne : en pipe, chaque trame du simulateur
+ * est donc traitée sans attendre la fin du flux.
+ *
+ * @param lecteur Lecteur ouvert
+ * @param stats Statistiques (octets_lus est mis à jour)
+ * @return false à la fin du flux ou sur erreur de lecture
+ */
+bool lire_bloc(LecteurFlux& lecteur, Statistiques& stats) {
+    size_t lus = 0;
+    if (!lire_entree(lecteur, lecteur.tampon.data() + lecteur.taille,
+                     TAILLE_BLOC_LECTURE, lus)) {
+        return false;
+    }
+    lecteur.taille += lus;
+    stats.octets_lus += lus;
+    return true;
+}
+
+/**
+ * @brief Retire les octets consommés et garde le reste au début du tampon
+ * @param lecteur Lecteur ouvert
+ * @param consommes Nombre d'octets traités depuis le début du tampon
+ */
+void consommer_bloc(LecteurFlux& lecteur, size_t consommes) {
+    size_t reste = lecteur.taille - consommes;
+    if (reste > 0 && consommes > 0) {
+        std::memmove(lecteur.tampon.data(), lecteur.tampon.data() + consommes, reste);
+    }
+    lecteur.taille = reste;
+}
+
+/**
+ * @brief Ferme la source si elle a été ouverte par ouvrir_flux()
+ */
+void fermer_flux(LecteurFlux& lecteur) {
+    if (lecteur.proprietaire && lecteur.fd >= 0) {
+        close(lecteur.fd);
+    }
+    lecteur.fd = -1;
+}
+
+/**
+ * @brief Fichier d'entrée projeté en mémoire (lecture seule)
+ *
+ * Les trames sont détectées et décodées directement dans les pages du
+ * fichier : aucune copie ni mise à zéro préalable d'un tampon.
+ */
+struct FichierMappe {
+    const uint8_t* donnees = nullptr;
+    size_t taille = 0;
+};
+
+/**
+ * @brief Projette un fichier régulier en mémoire avec mmap(2)
+ *
+ * Échoue sans message si la source n'est pas un fichier régulier non vide
+ * (pipe, FIFO, périphérique) ou si mmap échoue : l'appelant se rabat alors
+ * sur la lecture par blocs, qui rapporte elle-même les erreurs d'ouverture.
+ *
+ * @param carte Projection à initialiser
+ * @param source Nom du fichier
+ * @return true si le fichier est projeté
+ */
+bool mapper_fichier(FichierMappe& carte, const std::string& source) {
+    int fd = open(source.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t taille = static_cast<size_t>(info.st_size);
+    void* adresse = mmap(nullptr, taille, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // La projection reste valide après la fermeture
+    if (adresse == MAP_FAILED) {
+        return false;
+    }
+
+    // Lecture strictement séquentielle : lecture anticipée agressive
+    madvise(adresse, taille, MADV_SEQUENTIAL);
+
+    carte.donnees = static_cast<const uint8_t*>(adresse);
+    carte.taille = taille;
+    return true;
+}
+
+/**
+ * @brief Libère une projection créée par mapper_fichier()
+ */
+void liberer_fichier(FichierMappe& carte) {
+    if (carte.donnees != nullptr) {
+        munmap(const_cast<uint8_t*>(carte.donnees), carte.taille);
+    }
+    carte.donnees = nullptr;
+    carte.taille = 0;
+}
+
+/**
+ * @brief Tampon de texte réutilisé pour le rapport des trames
+ *
+ * Les lignes sont mises en forme directement dans ce tampon, sans flux ni
+ * locale, puis écrites dans `dest` par blocs de TAILLE_TAMPON_SORTIE octets.
+ * Dans le pipeline, `liaison` remplace `dest` : le tampon plein est confié
+ * au fil de rédaction et remplacé par un morceau libre.
+ */
+struct TamponSortie {
+    std::unique_ptr<char[]> memoire{new char[TAILLE_TAMPON_SORTIE]};
+    char* donnees = memoire.get();  // memoire, ou un morceau de liaison
+    size_t taille = 0;
+    std::ostream* dest = nullptr;
+    Liaison* liaison = nullptr;
+};
+
+/**
+ * @brief Écrit le contenu du tampon dans son flux de destination
+ */
+void vider_sortie(TamponSortie& tampon) {
+    if (tampon.taille == 0) {
+        return;
+    }
+    if (tampon.liaison != nullptr) {
+        envoyer_morceau(*tampon.liaison, Morceau{tampon.donnees, tampon.taille});
+        tampon.donnees = prendre_libre(*tampon.liaison).donnees;
+    } else {
+        tampon.dest->write(tampon.donnees, static_cast<std::streamsize>(tampon.taille));
+    }
+    tampon.taille = 0;
+}
+
+/**
+ * @brief Garantit @p n octets libres et retourne la position d'écriture
+ */
+char* reserver_sortie(TamponSortie& tampon, size_t n) {
+    if (tampon.taille + n > TAILLE_TAMPON_SORTIE) {
+        vider_sortie(tampon);
+    }
+    return tampon.donnees + tampon.taille;
+}
+
+/**
+ * @brief Prend en compte le texte écrit jusqu'à @p fin depuis reserver_sortie()
+ */
+void valider_sortie(TamponSortie& tampon, const char* fin) {
+    tampon.taille = static_cast<size_t>(fin - tampon.donnees);
+}
+
+/**
+ * @brief Copie un littéral (sans son '\0' final)
+ */
+template <size_t N>
+char* copier_texte(char* p, const char (&texte)[N]) {
+    std::memcpy(p, texte, N - 1);
+    return p + N - 1;
+}
+
+/**
+ * @brief Écrit un entier brut en virgule fixe, aligné à droite
+ *
+ * Même texte que std::fixed/std::setprecision(decimales)/std::setw(largeur)
+ * appliqués à brut / 10^decimales, calculé sans passer par un flottant.
+ *
+ * @param p Position d'écriture
+ * @param brut Valeur dans l'unité brute (centièmes, dixièmes, millièmes)
+ * @param decimales Nombre de décimales (1 à 3)
+ * @param largeur Largeur minimale du champ
+ * @return Position après le texte écrit
+ */
+char* ecrire_fixe(char* p, int32_t brut, unsigned decimales, unsigned largeur) {
+    char chiffres[16];
+    char* d = chiffres + sizeof(chiffres);
+    uint32_t valeur = brut < 0 ? static_cast<uint32_t>(-brut) : static_cast<uint32_t>(brut);
+
+    for (unsigned k = 0; k < decimales; k++) {
+        *--d = static_cast<char>('0' + valeur % 10);
+        valeur /= 10;
+    }
+    *--d = '.';
+    do {
+        *--d = static_cast<char>('0' + valeur % 10);
+        valeur /= 10;
+    } while (valeur != 0);
+    if (brut < 0) {
+        *--d = '-';
+    }
+
+    size_t longueur = static_cast<size_t>(chiffres + sizeof(chiffres) - d);
+    for (size_t k = longueur; k < largeur; k++) {
+        *p++ = ' ';
+    }
+    std::memcpy(p, d, longueur);
+    return p + longueur;
+}
+
+/**
+ * @brief Écrit un entier non signé en décimal, aligné à droite
+ */
+char* ecrire_entier(char* p, uint64_t valeur, unsigned largeur) {
+    char chiffres[24];
+    char* d = chiffres + sizeof(chiffres);
+    do {
+        *--d = static_cast<char>('0' + valeur % 10);
+        valeur /= 10;
+    } while (valeur != 0);
+
+    size_t longueur = static_cast<size_t>(chiffres + sizeof(chiffres) - d);
+    for (size_t k = longueur; k < largeur; k++) {
+        *p++ = ' ';
+    }
+    std::memcpy(p, d, longueur);
+    return p + longueur;
+}
+
+/**
+ * @brief Écrit "Trame #NNN\n" (numéro de séquence sur 3 caractères)
+ */
+char* formater_entete_trame(char* p, uint8_t sequence) {
+    p = copier_texte(p, "Trame #");
+    p[0] = sequence >= 100 ? static_cast<char>('0' + sequence / 100) : ' ';
+    p[1] = sequence >= 10 ? static_cast<char>('0' + sequence / 10 % 10) : ' ';
+    p[2] = static_cast<char>('0' + sequence % 10);
+    p[3] = '\n';
+    return p + 4;
+}
+
+/**
+ * @brief Écrit la ligne d'un axe à partir des valeurs brutes
+ *
+ * Format : "  Axe N: XXX.XX° | XXX.X°/s | X.XXX A [!ALERTE!]"
+ */
+char* formater_ligne_axe(char* p, size_t i, int16_t position, int16_t vitesse,
+                         uint16_t courant, bool alerte) {
+    p = copier_texte(p, "  Axe ");
+    *p++ = static_cast<char>('1' + i);
+    p = copier_texte(p, ": ");
+    p = ecrire_fixe(p, position, 2, 6);
+    p = copier_texte(p, "° | ");
+    p = ecrire_fixe(p, vitesse, 1, 5);
+    p = copier_texte(p, "°/s | ");
+    p = ecrire_fixe(p, courant, 3, 0);
+    p = copier_texte(p, " A");
+
+    if (alerte) {
+        p = copier_texte(p, " [!ALERTE!]");
+    }
+
+    *p++ = '\n';
+    return p;
+}
+
+/**
+ * @brief Écrit le rapport de la trame k d'un lot analysé
+ *
+ * Les valeurs sont relues dans la trame brute ; les alertes viennent de
+ * lot.alerte.
+ */
+void ecrire_trame_lot(TamponSortie& sortie, const LotTrames& lot, size_t k) {
+    char* p = reserver_sortie(sortie, TAILLE_MAX_RAPPORT_TRAME);
+    p = formater_entete_trame(p, lot.sequence[k]);
+    for (size_t i = 0; i < lot.nb_axes; i++) {
+        p = formater_ligne_axe(p, i, lot.position[i][k], lot.vitesse[i][k], lot.courant[i][k],
+                               (lot.alerte[k] >> i) & 1u);
+    }
+    *p++ = '\n';
+    valider_sortie(sortie, p);
+}
+
+/**
+ * @brief Écrit le résumé des statistiques
+ * @param sortie Flux de sortie
+ * @param stats Statistiques à afficher
+ */
+void ecrire_statistiques(std::ostream& sortie, const Statistiques& stats) {
+    sortie << "========================================\n";
+    sortie << "STATISTIQUES\n";
+    sortie << "========================================\n";
+    sortie << "Octets lus          : " << stats.octets_lus << "\n";
+    sortie << "Octets de bruit     : " << stats.octets_bruit << "\n";
+    sortie << "Trames valides      : " << stats.trames_valides << "\n";
+    sortie << "Trames avec alerte  : " << stats.trames_alerte << "\n";
+    sortie << "Trames rejetées     : " << stats.trames_rejetees << "\n";
+    
+    if (stats.trames_valides > 0) {
+        sortie << "Séquence min        : " << static_cast<int>(stats.sequence_min) << "\n";
+        sortie << "Séquence max        : " << static_cast<int>(stats.sequence_max) << "\n";
+        
+        // Pertes déduites de la séquence déroulée (voir SuiviSequence)
+        const SuiviSequence& suivi = stats.suivi;
+        int64_t perdues = std::max<int64_t>(suivi.perdues, 0);
+        double attendues = static_cast<double>(suivi.index + 1);
+        sortie << "Trames perdues      : " << perdues << "\n";
+        sortie << "Taux de perte       : " << std::fixed << std::setprecision(2)
+               << 100.0 * static_cast<double>(perdues) / attendues << " %\n";
+        sortie << "Trames en double    : " << suivi.doublons << "\n";
+        sortie << "Trames en désordre  : " << suivi.desordres << "\n";
+
+        // Agrégats par axe (unités physiques)
+        sortie << "----------------------------------------\n";
+        for (size_t i = 0; i < MAX_AXES && stats.axes[i].nb > 0; i++) {
+            const StatistiquesAxe& axe = stats.axes[i];
+            double rms = std::sqrt(axe.courant_moyen * axe.courant_moyen +
+                                   axe.courant_m2 / static_cast<double>(axe.nb));
+            sortie << "Axe " << (i + 1) << " position      : min "
+                   << std::setprecision(2) << axe.position_min / 100.0
+                   << "° | moy " << axe.position_moyenne / 100.0
+                   << "° | max " << axe.position_max / 100.0 << "°\n";
+            sortie << "Axe " << (i + 1) << " vitesse crête : "
+                   << std::setprecision(1) << axe.vitesse_crete / 10.0 << "°/s\n";
+            sortie << "Axe " << (i + 1) << " courant       : moy "
+                   << std::setprecision(3) << axe.courant_moyen / 1000.0
+                   << " A | RMS " << rms / 1000.0 << " A\n";
+        }
+    }
+    
+    sortie << "========================================\n";
+}
+
+// ============================================================================
+// Sortie colonnaire binaire (--columns)
+// ============================================================================
+//
+// Les trames décodées sont réécrites colonne par colonne, par blocs d'au plus
+// TAILLE_LOT trames, pour être relues (mmap) sans resynchronisation.
+// Tous les entiers sont en little-endian.
+//
+//   En-tête : "TLMC", u16 version, u16 nb_colonnes, u32 trames_par_bloc, u32 0,
+//             puis par colonne : char nom[12], char unite[8], u8 type
+//             (1 = int16, 2 = uint16, 3 = uint8), 3 octets à 0,
+//             f32 facteur (valeur physique = brut * facteur)
+//   Bloc    : "BLOC", u32 n, (i32 min, i32 max) par colonne, puis les
+//             colonnes (n valeurs chacune, dans l'ordre de l'en-tête),
+//             complété par des 0 jusqu'à un multiple de 8 octets
+//   Index   : "INDX", u32 nb_blocs, par bloc : u64 position, u64 rang de la
+//             première trame, u32 n, u32 0 ; puis u64 octets_lus,
+//             octets_bruit, trames_valides, trames_alerte
+//   Fin     : u64 position de l'index, "TLMC", u32 0
+//
+// Colonnes : position_1..N (int16, deg, 0.01), vitesse_1..N (int16, deg/s,
+// 0.1), courant_1..N (uint16, A, 0.001), sequence (uint8, 1), pour N = 6 axes
+// (19 colonnes) ou 7 (cobot, 22 colonnes).
+
+// Bloc le plus grand (TAILLE_LOT trames à MAX_AXES axes, remplissage compris)
+const size_t TAILLE_MAX_BLOC_COLONNES =
+    8 + 8 * nb_colonnes(MAX_AXES) + TAILLE_LOT * (3 * MAX_AXES * 2 + 1) + 7;
+// Entrées d'index réservées d'avance (4 M trames) ; l'index double au-delà
+const size_t NB_BLOCS_INDEX_INITIAL = 4096;
+
+/**
+ * @brief Entrée de l'index des blocs d'un fichier colonnaire
+ */
+struct BlocIndex {
+    uint64_t position;      // Position du bloc dans le fichier
+    uint64_t premiere;      // Rang de la première trame du bloc
+    uint32_t nb;            // Nombre de trames
+};
+
+/**
+ * @brief Écrivain de fichier colonnaire
+ *
+ * Les colonnes des lots analysés sont accumulées dans `attente` (même
+ * disposition que LotTrames) et écrites d'un bloc quand il est plein.
+ */
+struct EcrivainColonnes {
+    std::ostream* dest = nullptr;
+    uint64_t position = 0;          // Octets écrits dans dest
+    uint64_t trames = 0;            // Trames déjà écrites dans des blocs
+    std::vector<BlocIndex> index;
+    std::unique_ptr<LotTrames> attente{new LotTrames};
+    std::string octets;             // Tampon de mise en forme d'un bloc
+};
+
+/**
+ * @brief Ajoute un entier little-endian de @p nb_octets octets
+ */
+void ajouter_le(std::string& octets, uint64_t valeur, size_t nb_octets) {
+    for (size_t k = 0; k < nb_octets; k++) {
+        octets.push_back(static_cast<char>((valeur >> (8 * k)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Ajoute une colonne de n valeurs 16 bits en little-endian
+ */
+void ajouter_colonne_16(std::string& octets, const void* valeurs, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const uint16_t* v = static_cast<const uint16_t*>(valeurs);
+    for (size_t k = 0; k < n; k++) {
+        ajouter_le(octets, v[k], 2);
+    }
+#else
+    octets.append(static_cast<const char*>(valeurs), 2 * n);
+#endif
+}
+
+/**
+ * @brief Écrit les octets mis en forme et avance la position
+ */
+void emettre_octets(EcrivainColonnes& ecrivain) {
+    ecrivain.dest->write(ecrivain.octets.data(), static_cast<std::streamsize>(ecrivain.octets.size()));
+    ecrivain.position += ecrivain.octets.size();
+    ecrivain.octets.clear();
+}
+
+/**
+ * @brief Écrit l'en-tête du fichier (schéma et unités)
+ */
+void ecrire_entete_colonnes(EcrivainColonnes& ecrivain, size_t nb_axes) {
+    struct Genre { const char* prefixe; const char* unite; uint8_t type; float facteur; };
+    const Genre genres[3] = {
+        {"position_", "deg", 1, 0.01f},
+        {"vitesse_", "deg/s", 1, 0.1f},
+        {"courant_", "A", 2, 0.001f},
+    };
+
+    ecrivain.octets.reserve(TAILLE_MAX_BLOC_COLONNES);
+    ecrivain.index.reserve(NB_BLOCS_INDEX_INITIAL);
+
+    std::string& o = ecrivain.octets;
+    o.append("TLMC", 4);
+    ajouter_le(o, VERSION_COLONNES, 2);
+    ajouter_le(o, nb_colonnes(nb_axes), 2);
+    ajouter_le(o, TAILLE_LOT, 4);
+    ajouter_le(o, 0, 4);
+
+    auto descripteur = [&o](const std::string& nom, const char* unite, uint8_t type, float facteur) {
+        std::string n = nom.substr(0, 11), u = std::string(unite).substr(0, 7);
+        o.append(n).append(12 - n.size(), '\0');
+        o.append(u).append(8 - u.size(), '\0');
+        o.push_back(static_cast<char>(type));
+        o.append(3, '\0');
+        uint32_t bits;
+        std::memcpy(&bits, &facteur, sizeof(bits));
+        ajouter_le(o, bits, 4);
+    };
+    for (size_t c = 0; c < 3; c++) {
+        for (size_t i = 0; i < nb_axes; i++) {
+            const Genre& g = genres[c];
+            descripteur(g.prefixe + std::to_string(i + 1), g.unite, g.type, g.facteur);
+        }
+    }
+    descripteur("sequence", "", 3, 1.0f);
+
+    emettre_octets(ecrivain);
+}
+
+/**
+ * @brief Écrit les trames en attente sous forme d'un bloc
+ */
+void ecrire_bloc_colonnes(EcrivainColonnes& ecrivain) {
+    const LotTrames& lot = *ecrivain.attente;
+    const size_t n = lot.nb;
+    if (n == 0) {
+        return;
+    }
+
+    if (ecrivain.index.size() == ecrivain.index.capacity()) {
+        RegimeAllocations hors_regime(false);   // Une fois par doublement, pas par trame
+        ecrivain.index.reserve(2 * ecrivain.index.size() + 1);
+    }
+    ecrivain.index.push_back({ecrivain.position, ecrivain.trames, static_cast<uint32_t>(n)});
+
+    std::string& o = ecrivain.octets;
+    o.append("BLOC", 4);
+    ajouter_le(o, n, 4);
+
+    auto min_max = [&o, n](const auto* valeurs) {
+        int32_t mn = valeurs[0], mx = valeurs[0];
+        for (size_t k = 1; k < n; k++) {
+            mn = std::min<int32_t>(mn, valeurs[k]);
+            mx = std::max<int32_t>(mx, valeurs[k]);
+        }
+        ajouter_le(o, static_cast<uint32_t>(mn), 4);
+        ajouter_le(o, static_cast<uint32_t>(mx), 4);
+    };
+    const size_t nb_axes = lot.nb_axes;
+    for (size_t i = 0; i < nb_axes; i++) min_max(lot.position[i]);
+    for (size_t i = 0; i < nb_axes; i++) min_max(lot.vitesse[i]);
+    for (size_t i = 0; i < nb_axes; i++) min_max(lot.courant[i]);
+    min_max(lot.sequence);
+
+    for (size_t i = 0; i < nb_axes; i++) ajouter_colonne_16(o, lot.position[i], n);
+    for (size_t i = 0; i < nb_axes; i++) ajouter_colonne_16(o, lot.vitesse[i], n);
+    for (size_t i = 0; i < nb_axes; i++) ajouter_colonne_16(o, lot.courant[i], n);
+    o.append(reinterpret_cast<const char*>(lot.sequence), n);
+    o.append((8 - o.size() % 8) % 8, '\0');
+
+    emettre_octets(ecrivain);
+    ecrivain.trames += n;
+    ecrivain.attente->nb = 0;
+}
+
+/**
+ * @brief Ajoute les trames d'un lot décodé
+ */
+void ajouter_lot_colonnes(EcrivainColonnes& ecrivain, const LotTrames& lot) {
+    LotTrames& attente = *ecrivain.attente;
+    attente.nb_axes = lot.nb_axes;
+    size_t k = 0;
+    while (k < lot.nb) {
+        size_t n = std::min(lot.nb - k, TAILLE_LOT - attente.nb);
+        size_t d = attente.nb;
+        std::memcpy(attente.sequence + d, lot.sequence + k, n);
+        for (size_t i = 0; i < lot.nb_axes; i++) {
+            std::memcpy(attente.position[i] + d, lot.position[i] + k, n * sizeof(int16_t));
+            std::memcpy(attente.vitesse[i] + d, lot.vitesse[i] + k, n * sizeof(int16_t));
+            std::memcpy(attente.courant[i] + d, lot.courant[i] + k, n * sizeof(uint16_t));
+        }
+        attente.nb += n;
+        k += n;
+        if (attente.nb == TAILLE_LOT) {
+            ecrire_bloc_colonnes(ecrivain);
+        }
+    }
+}
+
+/**
+ * @brief Lots décodés d'un segment -j, gardés pour le fichier colonnaire
+ *
+ * Un segment ne peut pas découper lui-même ses blocs : leurs bornes dépendent
+ * du nombre de trames des segments précédents. Ses lots sont donc gardés et
+ * ajoutés à l'écrivain du fichier quand le segment est repris dans l'ordre ;
+ * le fichier est ainsi le même qu'en séquentiel.
+ */
+struct LotsGardes {
+    std::vector<std::unique_ptr<LotTrames>> lots;   // Réutilisés d'un segment à l'autre
+    size_t nb = 0;                                  // Lots utilisés
+};
+
+/**
+ * @brief Garde une copie d'un lot analysé
+ */
+void garder_lot(LotsGardes& gardes, const LotTrames& lot) {
+    if (gardes.nb == gardes.lots.size()) {
+        gardes.lots.emplace_back(new LotTrames);
+    }
+    *gardes.lots[gardes.nb++] = lot;
+}
+
+/**
+ * @brief Ajoute à l'écrivain du fichier les lots gardés d'un segment
+ */
+void ajouter_lots_gardes(EcrivainColonnes& ecrivain, const LotsGardes& gardes) {
+    for (size_t k = 0; k < gardes.nb; k++) {
+        ajouter_lot_colonnes(ecrivain, *gardes.lots[k]);
+    }
+}
+
+/**
+ * @brief Écrit le dernier bloc, l'index, les statistiques et la fin du fichier
+ */
+void terminer_colonnes(EcrivainColonnes& ecrivain, const Statistiques& stats) {
+    ecrire_bloc_colonnes(ecrivain);
+
+    uint64_t position_index = ecrivain.position;
+    std::string& o = ecrivain.octets;
+    o.append("INDX", 4);
+    ajouter_le(o, ecrivain.index.size(), 4);
+    for (const BlocIndex& bloc : ecrivain.index) {
+        ajouter_le(o, bloc.position, 8);
+        ajouter_le(o, bloc.premiere, 8);
+        ajouter_le(o, bloc.nb, 4);
+        ajouter_le(o, 0, 4);
+    }
+    ajouter_le(o, stats.octets_lus, 8);
+    ajouter_le(o, stats.octets_bruit, 8);
+    ajouter_le(o, stats.trames_valides, 8);
+    ajouter_le(o, stats.trames_alerte, 8);
+
+    ajouter_le(o, position_index, 8);
+    o.append("TLMC", 4);
+    ajouter_le(o, 0, 4);
+    emettre_octets(ecrivain);
+    ecrivain.dest->flush();
+}
+
+// ============================================================================
+// Fenêtres glissantes (--windows)
+// ============================================================================
+//
+// Le flux est découpé en secondes de trames_par_seconde trames (fréquence
+// annoncée par --rate, celle du simulateur). Chaque seconde terminée entre
+// dans un anneau de NB_SECONDES_FENETRE cases préallouées ; les sommes de
+// chaque fenêtre (1 s, 10 s, 60 s) sont tenues à jour en ajoutant la seconde
+// qui entre et en retirant celle qui sort. Une ligne par fenêtre est émise à
+// chaque seconde terminée.
+
+const size_t NB_SECONDES_FENETRE = 60;
+const size_t NB_FENETRES = 3;
+const size_t DUREE_FENETRE[NB_FENETRES] = {1, 10, 60};     // Secondes
+const size_t TAILLE_MAX_LIGNE_FENETRE = 256;
+
+/**
+ * @brief Sommes sur une seconde (ou une fenêtre) de trames
+ */
+struct CaseFenetre {
+    uint64_t trames = 0;
+    uint64_t courant[MAX_AXES] = {};    // Somme des courants (mA)
+    uint64_t alertes[MAX_AXES] = {};    // Trames avec l'axe en alerte
+};
+
+struct FenetresGlissantes {
+    size_t trames_par_seconde = 100;
+    size_t nb_axes = NB_AXES_BRAS;
+    uint64_t secondes = 0;              // Secondes terminées
+    CaseFenetre en_cours;
+    CaseFenetre anneau[NB_SECONDES_FENETRE];
+    CaseFenetre fenetre[NB_FENETRES];
+};
+
+/**
+ * @brief Ajoute (signe > 0) ou retire (signe < 0) une seconde d'une fenêtre
+ */
+void cumuler_case(CaseFenetre& somme, const CaseFenetre& seconde, int signe) {
+    if (signe > 0) {
+        somme.trames += seconde.trames;
+        for (size_t i = 0; i < MAX_AXES; i++) {
+            somme.courant[i] += seconde.courant[i];
+            somme.alertes[i] += seconde.alertes[i];
+        }
+    } else {
+        somme.trames -= seconde.trames;
+        for (size_t i = 0; i < MAX_AXES; i++) {
+            somme.courant[i] -= seconde.courant[i];
+            somme.alertes[i] -= seconde.alertes[i];
+        }
+    }
+}
+
+/**
+ * @brief Écrit la ligne d'une fenêtre
+ *
+ * Format : "[t=T s] D s : moy  X.XXX ... A | alertes N ..."
+ */
+char* formater_ligne_fenetre(char* p, uint64_t t, size_t duree, size_t nb_axes,
+                             const CaseFenetre& somme) {
+    p = copier_texte(p, "[t=");
+    p = ecrire_entier(p, t, 0);
+    p = copier_texte(p, " s] ");
+    p = ecrire_entier(p, duree, 2);
+    p = copier_texte(p, " s : moy");
+    for (size_t i = 0; i < nb_axes; i++) {
+        uint64_t moyenne = (somme.courant[i] + somme.trames / 2) / somme.trames;
+        *p++ = ' ';
+        p = ecrire_fixe(p, static_cast<int32_t>(moyenne), 3, 6);
+    }
+    p = copier_texte(p, " A | alertes");
+    for (size_t i = 0; i < nb_axes; i++) {
+        *p++ = ' ';
+        p = ecrire_entier(p, somme.alertes[i], 0);
+    }
+    *p++ = '\n';
+    return p;
+}
+
+/**
+ * @brief Fait entrer la seconde en cours dans l'anneau et émet les fenêtres
+ */
+void clore_seconde(FenetresGlissantes& fen, TamponSortie& sortie) {
+    for (size_t w = 0; w < NB_FENETRES; w++) {
+        cumuler_case(fen.fenetre[w], fen.en_cours, +1);
+        if (fen.secondes >= DUREE_FENETRE[w]) {
+            const CaseFenetre& ancienne =
+                fen.anneau[(fen.secondes - DUREE_FENETRE[w]) % NB_SECONDES_FENETRE];
+            cumuler_case(fen.fenetre[w], ancienne, -1);
+        }
+    }
+    // La case réutilisée vient d'être retirée de la fenêtre de 60 s
+    fen.anneau[fen.secondes % NB_SECONDES_FENETRE] = fen.en_cours;
+    fen.en_cours = CaseFenetre();
+    fen.secondes++;
+
+    for (size_t w = 0; w < NB_FENETRES; w++) {
+        char* p = reserver_sortie(sortie, TAILLE_MAX_LIGNE_FENETRE);
+        p = formater_ligne_fenetre(p, fen.secondes, DUREE_FENETRE[w], fen.nb_axes, fen.fenetre[w]);
+        valider_sortie(sortie, p);
+    }
+}
+
+/**
+ * @brief Ajoute un lot analysé aux fenêtres, seconde par seconde
+ */
+void suivre_fenetres(FenetresGlissantes& fen, const LotTrames& lot, TamponSortie& sortie) {
+    size_t k = 0;
+    while (k < lot.nb) {
+        size_t m = std::min(lot.nb - k, fen.trames_par_seconde - fen.en_cours.trames);
+        for (size_t i = 0; i < fen.nb_axes; i++) {
+            uint64_t courant = 0;
+            uint64_t alertes = 0;
+            for (size_t j = k; j < k + m; j++) {
+                courant += lot.courant[i][j];
+                alertes += (lot.alerte[j] >> i) & 1u;
+            }
+            fen.en_cours.courant[i] += courant;
+            fen.en_cours.alertes[i] += alertes;
+        }
+        fen.en_cours.trames += m;
+        k += m;
+
+        if (fen.en_cours.trames == fen.trames_par_seconde) {
+            clore_seconde(fen, sortie);
+        }
+    }
+}
+
+// ============================================================================
+// Surintensités soutenues (--events)
+// ============================================================================
+//
+// Un événement s'ouvre quand le courant d'un axe dépasse
+// SURINTENSITE_DECLENCHEMENT_PCT % de son courant nominal et ne se referme
+// que lorsqu'il repasse sous SURINTENSITE_RETOUR_PCT % (hystérésis). Il
+// n'est rapporté que s'il a duré au moins duree_min trames : les pics isolés
+// d'une seule trame ne produisent plus rien.
+
+// Courant nominal par axe (mêmes valeurs que COURANT_NOMINAL_A du simulateur ;
+// le 7e axe n'existe que sur le cobot)
+const uint16_t COURANT_NOMINAL_MA[MAX_AXES] = {8000, 6000, 4000, 2000, 2000, 1500, 1000};
+const uint32_t SURINTENSITE_DECLENCHEMENT_PCT = 120;
+const uint32_t SURINTENSITE_RETOUR_PCT = 100;
+const size_t DUREE_MIN_SURINTENSITE = 5;    // Trames (défaut de --min-frames)
+const size_t TAILLE_MAX_LIGNE_EVENEMENT = 128;
+
+struct EtatSurintensite {
+    bool actif = false;
+    uint8_t debut = 0;          // Séquence de la première trame au-dessus du seuil
+    uint8_t fin = 0;            // Séquence de la dernière trame de l'événement
+    uint16_t pic = 0;           // Courant maximal (mA)
+    uint64_t duree = 0;         // Trames
+};
+
+struct DetecteurSurintensite {
+    size_t duree_min = DUREE_MIN_SURINTENSITE;
+    size_t nb_axes = NB_AXES_BRAS;
+    uint16_t haut[MAX_AXES];    // Seuil de déclenchement (mA)
+    uint16_t bas[MAX_AXES];     // Seuil de retour (mA)
+    EtatSurintensite axes[MAX_AXES];
+    uint64_t evenements = 0;    // Événements rapportés
+};
+
+/**
+ * @brief Calcule les seuils de chaque axe à partir des courants nominaux
+ */
+void initialiser_detecteur(DetecteurSurintensite& det, size_t duree_min, size_t nb_axes) {
+    det.duree_min = duree_min;
+    det.nb_axes = nb_axes;
+    for (size_t i = 0; i < nb_axes; i++) {
+        det.haut[i] = static_cast<uint16_t>(COURANT_NOMINAL_MA[i] * SURINTENSITE_DECLENCHEMENT_PCT / 100);
+        det.bas[i] = static_cast<uint16_t>(COURANT_NOMINAL_MA[i] * SURINTENSITE_RETOUR_PCT / 100);
+    }
+}
+
+/**
+ * @brief Écrit la ligne d'un événement
+ *
+ * Format : "Surintensité axe N : séquences A -> B (D trames), pic X.XXX A"
+ */
+char* formater_evenement(char* p, size_t i, const EtatSurintensite& e, bool en_cours) {
+    p = copier_texte(p, "Surintensité axe ");
+    *p++ = static_cast<char>('1' + i);
+    p = copier_texte(p, " : séquences ");
+    p = ecrire_entier(p, e.debut, 3);
+    p = copier_texte(p, " -> ");
+    p = ecrire_entier(p, e.fin, 3);
+    p = copier_texte(p, " (");
+    p = ecrire_entier(p, e.duree, 0);
+    p = copier_texte(p, " trames), pic ");
+    p = ecrire_fixe(p, e.pic, 3, 0);
+    p = copier_texte(p, " A");
+    if (en_cours) {
+        p = copier_texte(p, " (en cours)");
+    }
+    *p++ = '\n';
+    return p;
+}
+
+/**
+ * @brief Referme l'événement d'un axe et le rapporte s'il a assez duré
+ */
+void clore_evenement(DetecteurSurintensite& det, size_t i, TamponSortie& sortie, bool en_cours) {
+    EtatSurintensite& e = det.axes[i];
+    if (e.duree >= det.duree_min) {
+        char* p = reserver_sortie(sortie, TAILLE_MAX_LIGNE_EVENEMENT);
+        valider_sortie(sortie, formater_evenement(p, i, e, en_cours));
+        det.evenements++;
+    }
+    e = EtatSurintensite();
+}
+
+/**
+ * @brief Fait avancer l'automate de chaque axe sur les trames d'un lot
+ *
+ * Un axe au repos dont aucun courant du lot ne dépasse le seuil haut (cas
+ * courant) est écarté par un simple maximum vectorisé sur sa colonne ;
+ * l'automate trame par trame ne tourne que sur les lots concernés.
+ */
+void detecter_surintensites(DetecteurSurintensite& det, const LotTrames& lot, TamponSortie& sortie) {
+    const size_t n = lot.nb;
+    for (size_t i = 0; i < det.nb_axes; i++) {
+        const uint16_t* courant = lot.courant[i];
+        const uint16_t haut = det.haut[i];
+        const uint16_t bas = det.bas[i];
+        EtatSurintensite& e = det.axes[i];
+
+        if (!e.actif) {
+            uint16_t maximum = 0;
+            for (size_t k = 0; k < n; k++) {
+                maximum = std::max(maximum, courant[k]);
+            }
+            if (maximum <= haut) {
+                continue;
+            }
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            uint16_t c = courant[k];
+            if (e.actif) {
+                if (c < bas) {
+                    clore_evenement(det, i, sortie, false);
+                } else {
+                    e.duree++;
+                    e.fin = lot.sequence[k];
+                    e.pic = std::max(e.pic, c);
+                }
+            } else if (c > haut) {
+                e.actif = true;
+                e.debut = e.fin = lot.sequence[k];
+                e.pic = c;
+                e.duree = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rapporte les événements encore ouverts en fin de flux et leur total
+ */
+void terminer_surintensites(DetecteurSurintensite& det, TamponSortie& sortie) {
+    for (size_t i = 0; i < det.nb_axes; i++) {
+        if (det.axes[i].actif) {
+            clore_evenement(det, i, sortie, true);
+        }
+    }
+    char* p = reserver_sortie(sortie, TAILLE_MAX_LIGNE_EVENEMENT);
+    p = copier_texte(p, "Événements de surintensité : ");
+    p = ecrire_entier(p, det.evenements, 0);
+    p = copier_texte(p, "\n\n");
+    valider_sortie(sortie, p);
+}
+
+// ============================================================================
+// Traitement des trames
+// ============================================================================
+
+// Trames écrites dans le rapport
+enum ModeRapport {
+    RAPPORT_COMPLET,    // Toutes les trames (défaut)
+    RAPPORT_ALERTES,    // Seulement les trames avec au moins un axe en alerte (--alerts-only)
+    RAPPORT_RESUME      // Aucune trame, seulement les statistiques (--summary)
+};
+
+/**
+ * @brief État d'analyse d'un flux : lot de travail, statistiques, rapport
+ */
+struct EtatAnalyse {
+    std::unique_ptr<LotTrames> lot{new LotTrames};
+    Statistiques stats;
+    TamponSortie texte;         // Rapport des trames (texte.dest : flux de sortie)
+    int32_t seuil_ma = 0;       // Voir seuil_en_milliamperes()
+    ModeRapport mode = RAPPORT_COMPLET;
+    size_t intervalle = 1;      // --every : une trame rapportable sur N
+    size_t candidats = 0;       // Trames rapportables vues jusqu'ici
+    EcrivainColonnes* colonnes = nullptr;   // --columns
+    LotsGardes* lots_gardes = nullptr;      // --columns, dans un segment -j
+    FenetresGlissantes* fenetres = nullptr; // --windows
+    DetecteurSurintensite* surintensites = nullptr; // --events
+    FormatTrame format;         // Modèle de bras (--axes), CRC (--crc)
+};
+
+/**
+ * @brief Analyse et rapporte les trames en attente dans le lot
+ */
+void vider_lot(EtatAnalyse& etat) {
+    LotTrames& lot = *etat.lot;
+    if (lot.nb == 0) {
+        return;
+    }
+
+    size_t alertes = etat.stats.trames_alerte;
+    analyser_lot(lot, etat.stats, etat.seuil_ma);
+    compter(METRIQUE_TRAMES, lot.nb);
+    compter(METRIQUE_ALERTES, etat.stats.trames_alerte - alertes);
+    if (etat.colonnes != nullptr) {
+        ajouter_lot_colonnes(*etat.colonnes, lot);
+    } else if (etat.lots_gardes != nullptr) {
+        garder_lot(*etat.lots_gardes, lot);
+    }
+
+    uint64_t debut = debut_mesure();
+    if (etat.mode != RAPPORT_RESUME) {
+        for (size_t k = 0; k < lot.nb; k++) {
+            if (etat.mode == RAPPORT_ALERTES && lot.alerte[k] == 0) {
+                continue;
+            }
+            if (etat.candidats++ % etat.intervalle == 0) {
+                ecrire_trame_lot(etat.texte, lot, k);
+            }
+        }
+    }
+    if (etat.fenetres != nullptr) {
+        suivre_fenetres(*etat.fenetres, lot, etat.texte);
+    }
+    if (etat.surintensites != nullptr) {
+        detecter_surintensites(*etat.surintensites, lot, etat.texte);
+    }
+    compter_duree(METRIQUE_NS_RAPPORT, debut);
+    lot.nb = 0;
+}
+
+/**
+ * @brief Ajoute une trame valide de Axes axes au lot, et le traite s'il est plein
+ */
+template <size_t Axes>
+inline void ajouter_trame(EtatAnalyse& etat, const VueTrame& trame) {
+    decoder_dans_lot<Axes>(*etat.lot, trame);
+    if (etat.lot->nb == TAILLE_LOT) {
+        vider_lot(etat);
+    }
+}
+
+/**
+ * @brief Détecte, décode et rapporte les trames complètes d'un tampon
+ *
+ * Les trames valides sont décodées dans le lot puis analysées et rapportées
+ * par paquets de TAILLE_LOT ; le lot est toujours vidé avant le retour, car
+ * le tampon peut être réutilisé ensuite.
+ *
+ * Les octets situés entre les trames sont comptés comme bruit. Si le tampon
+ * se termine au milieu d'une trame (ou sur un SYNC_H isolé), ces octets ne
+ * sont pas consommés afin d'être complétés par la lecture suivante, sauf si
+ * @p fin indique qu'aucune donnée ne suivra.
+ *
+ * @param buffer Début des données
+ * @param taille Nombre d'octets valides
+ * @param fin true si aucune donnée ne suivra ce tampon
+ * @param etat État d'analyse (son lot est vide à l'entrée et au retour)
+ * @return Nombre d'octets consommés depuis le début du tampon
+ */
+template <size_t Axes>
+size_t traiter_tampon(const uint8_t* buffer, size_t taille, bool fin, EtatAnalyse& etat) {
+    Statistiques& stats = etat.stats;
+    const FormatTrame& format = etat.format;
+    const size_t pas = taille_trame(format);
+    size_t pos = 0;
+    etat.lot->nb_axes = Axes;
+
+    while (pos < taille) {
+        int idx = trouver_sync(buffer, taille, pos);
+
+        if (idx < 0) {
+            // Pas de sync complet : garder un éventuel SYNC_H final
+            size_t garde = (!fin && buffer[taille - 1] == SYNC_H) ? 1 : 0;
+            stats.octets_bruit += taille - garde - pos;
+            vider_lot(etat);
+            return taille - garde;
+        }
+
+        size_t debut = static_cast<size_t>(idx);
+        stats.octets_bruit += debut - pos;
+
+        VerdictSync verdict = debut + pas > taille ? SYNC_INCOMPLET
+                                                   : confirmer_sync(buffer, taille, debut, pas, fin);
+        if (verdict == SYNC_INCOMPLET) {
+            // Trame incomplète, ou pas encore confirmée : attendre la suite
+            vider_lot(etat);
+            if (fin) {
+                stats.octets_bruit += taille - debut;
+                return taille;
+            }
+            return debut;
+        }
+        if (verdict == SYNC_ECARTE) {
+            stats.octets_bruit++;
+            compter(METRIQUE_SYNC_ECARTES, 1);
+            pos = debut + 1;
+            continue;
+        }
+
+        VueTrame trame{buffer + debut};
+        if (trame_acceptee(trame, format)) {
+            ajouter_trame<Axes>(etat, trame);
+        } else {
+            stats.trames_rejetees++;
+            stats.octets_bruit += pas;
+            compter(METRIQUE_SYNC_ECARTES, 1);
+        }
+        pos = debut + pas;
+    }
+
+    vider_lot(etat);
+    return pos;
+}
+
+/**
+ * @brief traiter_tampon() pour le modèle de bras de l'analyse
+ *
+ * L'aiguillage est fait une fois par tampon : la boucle des trames est
+ * celle, déroulée, du modèle.
+ */
+size_t traiter_tampon(const uint8_t* buffer, size_t taille, bool fin, EtatAnalyse& etat) {
+    uint64_t debut = debut_mesure();
+    size_t consommes = etat.format.nb_axes == NB_AXES_COBOT
+        ? traiter_tampon<NB_AXES_COBOT>(buffer, taille, fin, etat)
+        : traiter_tampon<NB_AXES_BRAS>(buffer, taille, fin, etat);
+    compter(METRIQUE_OCTETS, consommes);
+    compter_duree(METRIQUE_NS_TRAITEMENT, debut);
+    return consommes;
+}
+
+// ============================================================================
+// Lecture d'un conteneur compressé (TLMZ, ./simulateur --compress)
+// ============================================================================
+//
+// Le conteneur archive les trames seules (ni bruit ni CRC), par blocs,
+// champ par champ : écarts d'ordre 1 ou 2 en zigzag, tassés sur une largeur
+// fixe par colonne et par bloc, et exceptions pour les résidus trop larges.
+// La disposition exacte est décrite dans simulateur_telemetrie.cpp.
+//
+// Chaque bloc est décodé directement dans les colonnes du lot, puis analysé
+// comme les trames d'un fichier brut. Le décodage d'une colonne est sans
+// branchement : chaque résidu est extrait d'un chargement 64 bits par un
+// décalage et un masque constants (une fonction par largeur), puis les
+// sommes préfixes reconstruisent les valeurs. Les blocs se lisent dans
+// l'ordre de l'index de fin de fichier ; sans index (capture interrompue),
+// ils sont parcourus à la suite depuis l'en-tête.
+
+const char MAGIQUE_CONTENEUR[4] = {'T', 'L', 'M', 'Z'};
+const uint16_t VERSION_CONTENEUR = 1;
+const size_t TAILLE_ENTETE_CONTENEUR = 16;
+const size_t TAILLE_ENTETE_BLOC_CONTENEUR = 12;     // "BLKZ", u32 n, u32 taille
+const size_t TAILLE_ENTETE_COLONNE_CONTENEUR = 8;   // ordre, largeur, u16 exceptions, v0, v1
+const size_t TAILLE_FIN_CONTENEUR = 16;
+const size_t TAILLE_ENTREE_INDEX_CONTENEUR = 24;
+const size_t MARGE_BLOC_CONTENEUR = 8;              // Lectures 64 bits en fin de bloc
+
+/**
+ * @brief Vrai si le fichier commence par la signature d'un conteneur compressé
+ */
+bool est_conteneur(const uint8_t* donnees, size_t taille) {
+    return taille >= 4 && std::memcmp(donnees, MAGIQUE_CONTENEUR, 4) == 0;
+}
+
+/**
+ * @brief Reconstruit les valeurs d'une colonne de résidus tassés sur L bits
+ *
+ * L et l'ordre étant connus à la compilation, décalages et masques sont des
+ * constantes : par groupe de 8 résidus (L octets), 8 chargements sans
+ * dépendance entre eux. Les exceptions, triées par rang, remplacent leur
+ * champ (à 0) au passage ; la comparaison est presque toujours fausse.
+ *
+ * @param paquets Résidus tassés
+ * @param limite Premier octet qu'aucun chargement ne doit atteindre
+ * @param m Nombre de résidus (valeurs 2 à m + 1)
+ * @param exceptions nb_exceptions paires (u16 rang, u16 résidu), rangs croissants
+ * @param valeurs valeurs[0] et valeurs[1] déjà écrites ; reçoit les suivantes
+ */
+template <unsigned L, unsigned ORDRE>
+void reconstruire_colonne(const uint8_t* paquets, const uint8_t* limite, size_t m,
+                          const uint8_t* exceptions, size_t nb_exceptions, uint16_t* valeurs) {
+    const uint64_t masque = (1ull << L) - 1;
+    size_t prochaine = nb_exceptions > 0 ? lire_u16_le(exceptions) - 2u : SIZE_MAX;
+    uint16_t valeur = valeurs[1];
+    uint16_t ecart = static_cast<uint16_t>(valeurs[1] - valeurs[0]);
+
+    auto ajouter = [&](size_t j, uint64_t champ) {
+        uint16_t z = static_cast<uint16_t>(champ);
+        if (j == prochaine) {
+            z = lire_u16_le(exceptions + 2);
+            exceptions += 4;
+            prochaine = --nb_exceptions > 0 ? lire_u16_le(exceptions) - 2u : SIZE_MAX;
+        }
+        uint16_t r = static_cast<uint16_t>((z >> 1) ^ (0u - (z & 1u)));
+        if (ORDRE == 2) {
+            ecart = static_cast<uint16_t>(ecart + r);
+            r = ecart;
+        }
+        valeur = static_cast<uint16_t>(valeur + r);
+        valeurs[j + 2] = valeur;
+    };
+
+    size_t j = 0;
+    const uint8_t* p = paquets;
+    for (; j + 8 <= m && limite - p >= 24; j += 8, p += L) {
+        for (unsigned k = 0; k < 8; k++) {
+            uint64_t mot;
+            std::memcpy(&mot, p + (k * L) / 8, sizeof(mot));
+            ajouter(j + k, (mot >> ((k * L) % 8)) & masque);
+        }
+    }
+    for (; j < m; j++) {
+        size_t bit = j * L;
+        uint64_t mot;
+        std::memcpy(&mot, paquets + (bit >> 3), sizeof(mot));
+        ajouter(j, (mot >> (bit & 7)) & masque);
+    }
+}
+
+using FonctionReconstruction = void (*)(const uint8_t*, const uint8_t*, size_t,
+                                        const uint8_t*, size_t, uint16_t*);
+
+template <unsigned ORDRE, size_t... L>
+constexpr std::array<FonctionReconstruction, sizeof...(L)>
+table_reconstruction(std::index_sequence<L...>) {
+    return {{reconstruire_colonne<L, ORDRE>...}};
+}
+
+/**
+ * @brief Décode une colonne d'un bloc
+ * @param p Début de la colonne ; avancé après elle
+ * @param fin Fin des données utiles du bloc (la marge de 8 octets suit)
+ * @param n Nombre de trames du bloc
+ * @param valeurs Sortie : n valeurs 16 bits
+ * @return false si la colonne déborde du bloc ou est mal formée
+ */
+bool decoder_colonne_conteneur(const uint8_t*& p, const uint8_t* fin, size_t n,
+                               uint16_t* valeurs) {
+    // Une fonction par largeur (0 à 16 bits) et par ordre
+    static const auto ordre_1 = table_reconstruction<1>(std::make_index_sequence<17>());
+    static const auto ordre_2 = table_reconstruction<2>(std::make_index_sequence<17>());
+
+    if (fin - p < static_cast<ptrdiff_t>(TAILLE_ENTETE_COLONNE_CONTENEUR)) {
+        return false;
+    }
+    unsigned ordre = p[0];
+    size_t largeur = p[1];
+    size_t nb_exceptions = lire_u16_le(p + 2);
+    valeurs[0] = lire_u16_le(p + 4);
+    uint16_t v1 = lire_u16_le(p + 6);
+    p += TAILLE_ENTETE_COLONNE_CONTENEUR;
+
+    size_t m = n > 2 ? n - 2 : 0;
+    size_t octets_paquets = (m * largeur + 7) / 8;
+    if ((ordre != 1 && ordre != 2) || largeur > 16 ||
+        static_cast<size_t>(fin - p) < octets_paquets + 4 * nb_exceptions) {
+        return false;
+    }
+    const uint8_t* exceptions = p + octets_paquets;
+    size_t rang_precedent = 1;
+    for (size_t e = 0; e < nb_exceptions; e++) {
+        size_t rang = lire_u16_le(exceptions + 4 * e);
+        if (rang <= rang_precedent || rang >= n) {
+            return false;
+        }
+        rang_precedent = rang;
+    }
+
+    if (n > 1) {
+        valeurs[1] = v1;
+        const auto& table = ordre == 1 ? ordre_1 : ordre_2;
+        table[largeur](p, fin + MARGE_BLOC_CONTENEUR, m, exceptions, nb_exceptions, valeurs);
+    }
+    p = exceptions + 4 * nb_exceptions;
+    return true;
+}
+
+/**
+ * @brief Décode un bloc dans le lot (vide) de l'analyse, de lot.nb_axes axes
+ * @param bloc Début du bloc ("BLKZ")
+ * @param fin Fin de la zone des blocs (début de l'index)
+ */
+bool decoder_bloc_conteneur(const uint8_t* bloc, const uint8_t* fin, LotTrames& lot) {
+    if (fin - bloc < static_cast<ptrdiff_t>(TAILLE_ENTETE_BLOC_CONTENEUR) ||
+        std::memcmp(bloc, "BLKZ", 4) != 0) {
+        return false;
+    }
+    size_t n = lire_u32_le(bloc + 4);
+    size_t taille = lire_u32_le(bloc + 8);
+    const uint8_t* p = bloc + TAILLE_ENTETE_BLOC_CONTENEUR;
+    if (n == 0 || n > TAILLE_LOT || taille < MARGE_BLOC_CONTENEUR ||
+        static_cast<size_t>(fin - p) < taille) {
+        return false;
+    }
+    const uint8_t* fin_bloc = p + taille - MARGE_BLOC_CONTENEUR;
+
+    // Colonnes : position_1..N, vitesse_1..N, courant_1..N, séquence
+    bool ok = true;
+    for (size_t i = 0; i < lot.nb_axes && ok; i++) {
+        ok = decoder_colonne_conteneur(p, fin_bloc, n, reinterpret_cast<uint16_t*>(lot.position[i]));
+    }
+    for (size_t i = 0; i < lot.nb_axes && ok; i++) {
+        ok = decoder_colonne_conteneur(p, fin_bloc, n, reinterpret_cast<uint16_t*>(lot.vitesse[i]));
+    }
+    for (size_t i = 0; i < lot.nb_axes && ok; i++) {
+        ok = decoder_colonne_conteneur(p, fin_bloc, n, lot.courant[i]);
+    }
+    uint16_t sequence[TAILLE_LOT];
+    ok = ok && decoder_colonne_conteneur(p, fin_bloc, n, sequence);
+    if (!ok) {
+        return false;
+    }
+    for (size_t k = 0; k < n; k++) {
+        lot.sequence[k] = static_cast<uint8_t>(sequence[k]);
+    }
+    lot.nb = n;
+    return true;
+}
+
+/**
+ * @brief Analyse à la suite les blocs d'un conteneur privé de son index
+ *
+ * Le simulateur interrompu n'a écrit ni l'index ni la fin : les blocs
+ * complets, qui se suivent depuis l'en-tête, sont analysés jusqu'au premier
+ * bloc tronqué ou mal formé.
+ */
+void analyser_blocs_sans_index(const uint8_t* donnees, size_t taille, EtatAnalyse& etat) {
+    const uint8_t* bloc = donnees + TAILLE_ENTETE_CONTENEUR;
+    const uint8_t* fin = donnees + taille;
+    size_t nb_blocs = 0;
+    while (decoder_bloc_conteneur(bloc, fin, *etat.lot)) {
+        bloc += TAILLE_ENTETE_BLOC_CONTENEUR + lire_u32_le(bloc + 8);
+        nb_blocs++;
+        vider_lot(etat);
+        vider_sortie(etat.texte);
+    }
+    etat.lot->nb = 0;
+    bool complet = fin - bloc >= 4 && std::memcmp(bloc, "INDX", 4) == 0;
+    std::cerr << "Note: conteneur sans index" << (complet ? " (index tronqué)" : "")
+              << ", " << nb_blocs << " blocs lus à la suite";
+    if (bloc < fin && !complet) {
+        std::cerr << ", " << fin - bloc << " octets ignorés après le dernier bloc complet";
+    }
+    std::cerr << "\n";
+}
+
+/**
+ * @brief Analyse un conteneur compressé projeté en mémoire
+ *
+ * Les statistiques de bruit sont nulles : le conteneur n'en garde pas. Un
+ * conteneur sans index valide est lu par analyser_blocs_sans_index().
+ *
+ * @return false (message sur stderr) si le conteneur est mal formé
+ */
+bool analyser_conteneur(const FichierMappe& carte, EtatAnalyse& etat) {
+    const uint8_t* donnees = carte.donnees;
+    const size_t taille = carte.taille;
+    auto invalide = [](const char* raison) {
+        std::cerr << "Erreur: conteneur compressé invalide (" << raison << ")\n";
+        return false;
+    };
+
+    if (taille < TAILLE_ENTETE_CONTENEUR) {
+        return invalide("trop court");
+    }
+    if (lire_u16_le(donnees + 4) != VERSION_CONTENEUR ||
+        lire_u16_le(donnees + 6) != nb_colonnes(etat.format.nb_axes) ||
+        lire_u32_le(donnees + 8) > TAILLE_LOT) {
+        return invalide("version ou schéma non pris en charge, --axes ?");
+    }
+    etat.lot->nb_axes = etat.format.nb_axes;
+    uint64_t debut = debut_mesure();
+    const uint8_t* fin = donnees + taille - TAILLE_FIN_CONTENEUR;
+    uint64_t position_index = taille >= TAILLE_ENTETE_CONTENEUR + TAILLE_FIN_CONTENEUR
+                                  ? lire_u64_le(fin) : 0;
+    if (position_index < TAILLE_ENTETE_CONTENEUR ||
+        std::memcmp(fin + 8, MAGIQUE_CONTENEUR, 4) != 0 ||
+        position_index + 8 > taille - TAILLE_FIN_CONTENEUR ||
+        std::memcmp(donnees + position_index, "INDX", 4) != 0 ||
+        (taille - TAILLE_FIN_CONTENEUR - position_index - 8) / TAILLE_ENTREE_INDEX_CONTENEUR <
+            lire_u32_le(donnees + position_index + 4)) {
+        analyser_blocs_sans_index(donnees, taille, etat);
+        compter_duree(METRIQUE_NS_TRAITEMENT, debut);
+        return true;
+    }
+    const uint8_t* index = donnees + position_index;
+    size_t nb_blocs = lire_u32_le(index + 4);
+
+    for (size_t b = 0; b < nb_blocs; b++) {
+        const uint8_t* entree = index + 8 + b * TAILLE_ENTREE_INDEX_CONTENEUR;
+        uint64_t position = lire_u64_le(entree);
+        if (position >= position_index ||
+            !decoder_bloc_conteneur(donnees + position, index, *etat.lot) ||
+            etat.lot->nb != lire_u32_le(entree + 16)) {
+            etat.lot->nb = 0;
+            return invalide("bloc mal formé");
+        }
+        vider_lot(etat);
+        vider_sortie(etat.texte);
+    }
+    compter_duree(METRIQUE_NS_TRAITEMENT, debut);
+    return true;
+}
+
+// ============================================================================
+// Pipeline du mode flux (lecture / analyse / rédaction)
+// ============================================================================
+//
+// En flux (stdin, pipe), la lecture, l'analyse et l'écriture du rapport
+// tournent sur trois fils reliés par des Liaison : une sortie lente (terminal,
+// disque) ne bloque plus la lecture tant que des morceaux restent libres, et
+// le simulateur n'est plus ralenti par les rafales de rapport.
+
+// Cœurs des étages (--pin), -1 : pas d'épinglage
+struct CoeursPipeline {
+    int lecture = -1;
+    int analyse = -1;
+    int redaction = -1;
+};
+
+/**
+ * @brief Épingle un fil sur un cœur (sans effet si coeur < 0)
+ */
+void epingler_fil(pthread_t fil, int coeur) {
+    if (coeur < 0) {
+        return;
+    }
+    cpu_set_t ensemble;
+    CPU_ZERO(&ensemble);
+    CPU_SET(coeur, &ensemble);
+    if (pthread_setaffinity_np(fil, sizeof(ensemble), &ensemble) != 0) {
+        std::cerr << "Note: impossible d'épingler un fil sur le cœur " << coeur << "\n";
+    }
+}
+
+/**
+ * @brief Étage de lecture : remplit les morceaux de la liaison d'entrée
+ */
+void etage_lecture(LecteurFlux& lecteur, Liaison& entree) {
+    declarer_fil_metriques("lecture");
+    RegimeAllocations regime;
+    for (;;) {
+        Morceau morceau = prendre_libre(entree);
+        if (!lire_entree(lecteur, reinterpret_cast<uint8_t*>(morceau.donnees),
+                         entree.taille_morceau, morceau.taille)) {
+            envoyer_morceau(entree, Morceau());
+            return;
+        }
+        envoyer_morceau(entree, morceau);
+    }
+}
+
+/**
+ * @brief Étage de rédaction : écrit les morceaux de rapport dans l'ordre
+ */
+void etage_redaction(Liaison& texte, std::ostream& sortie) {
+    declarer_fil_metriques("redaction");
+    RegimeAllocations regime;
+    for (;;) {
+        Morceau morceau = recevoir_morceau(texte);
+        if (morceau.taille == 0) {
+            return;
+        }
+        sortie.write(morceau.donnees, static_cast<std::streamsize>(morceau.taille));
+        sortie.flush();
+        rendre_morceau(texte, morceau);
+    }
+}
+
+/**
+ * @brief Écrit sur stderr les attentes de chaque liaison (--pipeline-stats)
+ */
+void ecrire_metriques_pipeline(const Liaison& entree, const Liaison& texte) {
+    auto ms = [](const Attentes& a) { return static_cast<double>(a.ns) / 1e6; };
+    std::cerr << std::fixed << std::setprecision(1)
+              << "Pipeline : lecture bloquée " << entree.producteur.nb << " fois ("
+              << ms(entree.producteur) << " ms), analyse sans entrée "
+              << entree.consommateur.nb << " fois (" << ms(entree.consommateur) << " ms)\n"
+              << "Pipeline : analyse bloquée par la sortie " << texte.producteur.nb << " fois ("
+              << ms(texte.producteur) << " ms), rédaction sans texte "
+              << texte.consommateur.nb << " fois (" << ms(texte.consommateur) << " ms)\n"
+              << "Pipeline : file d'entrée " << entree.occupation_max << "/" << NB_MORCEAUX
+              << " au plus, file de sortie " << texte.occupation_max << "/" << NB_MORCEAUX
+              << " au plus\n";
+}
+
+/**
+ * @brief Analyse un flux sur trois fils
+ *
+ * Le fil appelant est l'étage d'analyse : chaque morceau lu est traité en
+ * place par traiter_tampon(), le reste du précédent (au plus
+ * TAILLE_MAX_RESTE octets) recopié dans sa marge, et le texte produit est
+ * confié au fil de rédaction.
+ * Au retour, les deux autres fils sont terminés et etat.texte écrit de
+ * nouveau directement dans @p sortie.
+ *
+ * @param lecteur Lecteur ouvert, premier bloc déjà lu
+ * @param encore false si ce premier bloc était aussi le dernier
+ */
+void analyser_en_pipeline(LecteurFlux& lecteur, bool encore, EtatAnalyse& etat,
+                          std::ostream& sortie, const CoeursPipeline& coeurs, bool metriques) {
+    std::unique_ptr<Liaison> entree(new Liaison);
+    std::unique_ptr<Liaison> texte(new Liaison);
+    preparer_liaison(*entree, TAILLE_BLOC_LECTURE, TAILLE_MAX_RESTE);
+    preparer_liaison(*texte, TAILLE_TAMPON_SORTIE);
+
+    vider_sortie(etat.texte);
+    sortie.flush();
+    etat.texte.liaison = texte.get();
+    etat.texte.donnees = prendre_libre(*texte).donnees;
+
+    std::thread redacteur(etage_redaction, std::ref(*texte), std::ref(sortie));
+    epingler_fil(redacteur.native_handle(), coeurs.redaction);
+    std::thread lecture;
+    if (encore) {
+        lecture = std::thread(etage_lecture, std::ref(lecteur), std::ref(*entree));
+        epingler_fil(lecture.native_handle(), coeurs.lecture);
+    }
+    epingler_fil(pthread_self(), coeurs.analyse);
+
+    RegimeAllocations regime;
+    bool fin = !encore;
+    const uint8_t* bloc = lecteur.tampon.data();    // Premier bloc, déjà lu
+    size_t taille = lecteur.taille;
+    Morceau courant;                                // Morceau de `bloc`, à rendre
+    for (;;) {
+        size_t consommes = traiter_tampon(bloc, taille, fin, etat);
+        vider_sortie(etat.texte);
+        if (fin) {
+            break;
+        }
+
+        size_t reste = taille - consommes;
+        Morceau morceau = recevoir_morceau(*entree);
+        if (morceau.taille == 0) {
+            fin = true;     // Dernier passage sur le reste du tampon
+            bloc += consommes;
+            taille = reste;
+            continue;
+        }
+        uint8_t* debut = reinterpret_cast<uint8_t*>(morceau.donnees) - reste;
+        std::memcpy(debut, bloc + consommes, reste);
+        if (courant.donnees != nullptr) {
+            rendre_morceau(*entree, courant);
+        }
+        courant = morceau;
+        bloc = debut;
+        taille = reste + morceau.taille;
+        etat.stats.octets_lus += morceau.taille;
+    }
+    if (courant.donnees != nullptr) {
+        rendre_morceau(*entree, courant);
+    }
+    lecteur.taille = 0;
+
+    if (lecture.joinable()) {
+        lecture.join();
+    }
+    envoyer_morceau(*texte, Morceau());
+    redacteur.join();
+    etat.texte.liaison = nullptr;
+    etat.texte.donnees = etat.texte.memoire.get();
+
+    if (metriques) {
+        ecrire_metriques_pipeline(*entree, *texte);
+    }
+}
+
+// ============================================================================
+// Analyse parallèle d'un fichier mappé (-j)
+// ============================================================================
+//
+// Le fichier est découpé en segments contigus, un par fil d'exécution.
+// Chaque segment rapporte les trames dont le premier octet tombe dans
+// [debut, fin). Pour reproduire exactement le parcours séquentiel, un
+// segment commence sa recherche RECOUVREMENT_SEGMENT octets avant son début
+// (sans rien rapporter) et note la première trame qu'il trouve à partir de
+// `debut`. Le segment précédent note de son côté la première trame de sa
+// chaîne à partir de `fin`. Si les deux positions diffèrent (resync tombée
+// sur un faux sync dans le recouvrement), le segment est recalculé depuis la
+// position trouvée par son prédécesseur.
+//
+// Les segments sont courts (TAILLE_SEGMENT) et bien plus nombreux que les
+// fils : chaque fil prend le suivant quand une place se libère, et le fil
+// principal les reprend dans l'ordre pour les raccorder et écrire leur
+// rapport. La mémoire retenue est donc bornée par le nombre de places, quelle
+// que soit la taille de la capture.
+
+/**
+ * @brief Segment d'un fichier mappé analysé par un fil
+ */
+struct Segment {
+    size_t debut = 0;               // Trames rapportées : premier octet dans [debut, fin)
+    size_t fin = 0;
+    size_t entree = 0;              // Position où la recherche commence
+    size_t premiere = AUCUNE_POSITION;  // Première trame de la chaîne >= debut
+    size_t suivante = AUCUNE_POSITION;  // Première trame de la chaîne >= fin
+    size_t premier_candidat = 0;    // Trames rapportables avant ce segment (--every)
+    int base_sequence = -1;         // Séquence de départ imposée au suivi (-1 : aucune)
+    EtatAnalyse etat;
+    std::ostream* sortie = nullptr; // Rapport écrit directement ici (sinon dans rapport)
+    std::ostringstream rapport;
+    std::unique_ptr<LotsGardes> colonnes;           // Si --columns
+};
+
+/**
+ * @brief Parcourt un segment : mêmes règles que traiter_tampon() en fin de flux
+ * @param donnees Fichier mappé complet
+ * @param taille Taille du fichier
+ * @param seg Segment à analyser (etat.stats et rapport repartent de zéro)
+ */
+template <size_t Axes>
+void analyser_segment(const uint8_t* donnees, size_t taille, Segment& seg) {
+    seg.etat.stats = Statistiques();
+    seg.etat.stats.octets_lus = seg.fin - seg.debut;
+    if (seg.base_sequence >= 0) {
+        SuiviSequence& suivi = seg.etat.stats.suivi;
+        suivi.demarre = true;
+        suivi.depuis_base = true;
+        suivi.premiere = suivi.courante = static_cast<uint8_t>(seg.base_sequence);
+    }
+    seg.etat.candidats = seg.premier_candidat;
+    if (seg.sortie != nullptr) {
+        seg.etat.texte.dest = seg.sortie;
+    } else {
+        seg.rapport.str("");
+        seg.etat.texte.dest = &seg.rapport;
+    }
+    if (seg.colonnes) {
+        seg.colonnes->nb = 0;
+        seg.etat.lots_gardes = seg.colonnes.get();
+    }
+    seg.premiere = AUCUNE_POSITION;
+    seg.suivante = AUCUNE_POSITION;
+
+    const FormatTrame& format = seg.etat.format;
+    const size_t pas = taille_trame(format);
+    size_t pos = seg.entree;
+    seg.etat.lot->nb_axes = Axes;
+    for (;;) {
+        size_t idx = pos < taille ? chercher_sync(donnees, taille, pos) : AUCUNE_POSITION;
+        if (idx == AUCUNE_POSITION || idx + pas > taille) {
+            break;  // Plus aucune trame complète
+        }
+        if (idx >= seg.debut && seg.premiere == AUCUNE_POSITION) {
+            seg.premiere = idx;
+        }
+        if (idx >= seg.fin) {
+            seg.suivante = idx;
+            break;
+        }
+        if (confirmer_sync(donnees, taille, idx, pas, true) == SYNC_ECARTE) {
+            compter(METRIQUE_SYNC_ECARTES, idx >= seg.debut);
+            pos = idx + 1;
+            continue;
+        }
+
+        VueTrame trame{donnees + idx};
+        if (idx >= seg.debut) {
+            if (trame_acceptee(trame, format)) {
+                ajouter_trame<Axes>(seg.etat, trame);
+            } else {
+                seg.etat.stats.trames_rejetees++;
+                compter(METRIQUE_SYNC_ECARTES, 1);
+            }
+        }
+        pos = idx + pas;
+    }
+    vider_lot(seg.etat);
+    vider_sortie(seg.etat.texte);
+}
+
+/**
+ * @brief analyser_segment() pour le modèle de bras du segment
+ */
+void analyser_segment(const uint8_t* donnees, size_t taille, Segment& seg) {
+    uint64_t debut = debut_mesure();
+    if (seg.etat.format.nb_axes == NB_AXES_COBOT) {
+        analyser_segment<NB_AXES_COBOT>(donnees, taille, seg);
+    } else {
+        analyser_segment<NB_AXES_BRAS>(donnees, taille, seg);
+    }
+    compter(METRIQUE_OCTETS, seg.fin - seg.debut);
+    compter_duree(METRIQUE_NS_TRAITEMENT, debut);
+}
+
+/**
+ * @brief Segments d'un fichier mappé, analysés par des fils et repris dans l'ordre
+ *
+ * Le segment k occupe la place k % places.size() ; un fil ne la prend
+ * qu'une fois le segment qui l'occupait repris par le fil principal.
+ */
+struct FileSegments {
+    const FichierMappe* carte = nullptr;
+    std::vector<size_t> bornes;             // Segment k : [bornes[k], bornes[k + 1])
+    std::vector<size_t> entrees;            // Point d'entrée de chaque segment
+    std::vector<size_t> premiers_candidats; // Trames rapportables avant chacun (--every)
+    std::vector<std::unique_ptr<Segment>> places;
+    std::vector<size_t> analyses;           // Par place : segment analysé, ou AUCUNE_POSITION
+    size_t prochain = 0;                    // Prochain segment à prendre
+    size_t repris = 0;                      // Segments repris par le fil principal
+    std::mutex verrou;
+    std::condition_variable signal;
+};
+
+inline size_t nb_segments(const FileSegments& file) {
+    return file.bornes.size() - 1;
+}
+
+/**
+ * @brief Fil d'analyse : prend les segments un à un, dès qu'une place est libre
+ */
+void analyser_file_segments(FileSegments* file) {
+    declarer_fil_metriques("segment");
+    const size_t nb_places = file->places.size();
+    for (;;) {
+        size_t k;
+        {
+            std::unique_lock<std::mutex> garde(file->verrou);
+            if (file->prochain == nb_segments(*file)) {
+                return;
+            }
+            k = file->prochain++;
+            file->signal.wait(garde, [file, k, nb_places]() { return k < file->repris + nb_places; });
+        }
+
+        Segment& seg = *file->places[k % nb_places];
+        seg.debut = file->bornes[k];
+        seg.fin = file->bornes[k + 1];
+        seg.entree = file->entrees[k];
+        seg.premier_candidat = file->premiers_candidats[k];
+        seg.base_sequence = -1;
+        analyser_segment(file->carte->donnees, file->carte->taille, seg);
+
+        {
+            std::lock_guard<std::mutex> garde(file->verrou);
+            file->analyses[k % nb_places] = k;
+        }
+        file->signal.notify_all();
+    }
+}
+
+/**
+ * @brief Analyse tous les segments sur nb_fils fils et les rend dans l'ordre
+ *
+ * Chaque segment est raccordé au précédent (recalculé depuis la position
+ * trouvée par celui-ci si elle diffère, point d'entrée noté pour une passe
+ * suivante) avant d'être passé à @p reprendre, sa place étant libérée ensuite.
+ *
+ * @param reprendre Appelé sur le fil principal avec (k, segment)
+ */
+template <typename Reprise>
+void parcourir_segments(FileSegments& file, size_t nb_fils, Reprise reprendre) {
+    const size_t nb_places = file.places.size();
+    const FichierMappe& carte = *file.carte;
+    file.prochain = 0;
+    file.repris = 0;
+    file.analyses.assign(nb_places, AUCUNE_POSITION);
+
+    std::vector<std::thread> fils;
+    for (size_t f = 0; f < nb_fils; f++) {
+        fils.emplace_back(analyser_file_segments, &file);
+    }
+
+    size_t suivante = AUCUNE_POSITION;
+    for (size_t k = 0; k < nb_segments(file); k++) {
+        {
+            std::unique_lock<std::mutex> garde(file.verrou);
+            file.signal.wait(garde, [&file, k, nb_places]() {
+                return file.analyses[k % nb_places] == k;
+            });
+        }
+        Segment& seg = *file.places[k % nb_places];
+        if (k > 0 && seg.premiere != suivante) {
+            seg.entree = suivante == AUCUNE_POSITION ? carte.taille : suivante;
+            file.entrees[k] = seg.entree;
+            analyser_segment(carte.donnees, carte.taille, seg);
+        }
+        suivante = seg.suivante;
+        reprendre(k, seg);
+
+        {
+            std::lock_guard<std::mutex> garde(file.verrou);
+            file.repris++;
+        }
+        file.signal.notify_all();
+    }
+    for (auto& f : fils) {
+        f.join();
+    }
+}
+
+/**
+ * @brief Analyse un fichier mappé sur plusieurs fils
+ *
+ * Le rapport produit est identique à celui du parcours séquentiel et il est
+ * écrit au fil de l'analyse, segment par segment. Avec --every, la
+ * décimation dépend du rang global des trames : une première passe sans
+ * rapport compte les trames rapportables de chaque segment.
+ *
+ * @param carte Fichier mappé
+ * @param nb_fils Nombre de fils demandé
+ * @param etat État d'analyse principal (statistiques totales, sortie, options)
+ */
+void analyser_en_parallele(const FichierMappe& carte, size_t nb_fils, EtatAnalyse& etat) {
+    // Des segments trop petits ne justifient pas un fil
+    size_t max_segments = std::max<size_t>(1, carte.taille / (4 * RECOUVREMENT_SEGMENT));
+    size_t nb = std::min(std::max(nb_fils, (carte.taille + TAILLE_SEGMENT - 1) / TAILLE_SEGMENT),
+                         max_segments);
+    size_t nb_places = std::min(nb, SEGMENTS_PAR_FIL * nb_fils);
+    nb_fils = std::min(nb_fils, nb);
+    bool decime = etat.intervalle > 1 && etat.mode != RAPPORT_RESUME;
+
+    FileSegments file;
+    file.carte = &carte;
+    for (size_t k = 0; k <= nb; k++) {
+        file.bornes.push_back(carte.taille * k / nb);
+    }
+    for (size_t k = 0; k < nb; k++) {
+        size_t debut = file.bornes[k];
+        file.entrees.push_back(debut > RECOUVREMENT_SEGMENT ? debut - RECOUVREMENT_SEGMENT : 0);
+    }
+    file.premiers_candidats.assign(nb, 0);
+    for (size_t p = 0; p < nb_places; p++) {
+        std::unique_ptr<Segment> seg(new Segment);
+        seg->etat.seuil_ma = etat.seuil_ma;
+        seg->etat.format = etat.format;
+        seg->etat.mode = decime ? RAPPORT_RESUME : etat.mode;
+        seg->etat.intervalle = etat.intervalle;
+        if (etat.colonnes != nullptr) {
+            seg->colonnes.reset(new LotsGardes);
+        }
+        file.places.push_back(std::move(seg));
+    }
+
+    if (decime) {
+        // Les points d'entrée sont exacts à l'issue de cette passe sans rapport
+        size_t candidats = 0;
+        parcourir_segments(file, nb_fils, [&](size_t k, Segment& seg) {
+            file.premiers_candidats[k] = candidats;
+            const Statistiques& st = seg.etat.stats;
+            candidats += etat.mode == RAPPORT_ALERTES ? st.trames_alerte : st.trames_valides;
+        });
+        for (auto& seg : file.places) {
+            seg->etat.mode = etat.mode;
+        }
+    }
+
+    parcourir_segments(file, nb_fils, [&](size_t, Segment& seg) {
+        // Une trame en retard juste après la frontière se compare, en
+        // séquentiel, à la séquence du segment précédent : recalcul.
+        const SuiviSequence& total = etat.stats.suivi;
+        const SuiviSequence& partie = seg.etat.stats.suivi;
+        if (total.demarre && partie.demarre &&
+            static_cast<int8_t>(static_cast<uint8_t>(partie.premiere - total.courante)) < 0) {
+            seg.base_sequence = total.courante;
+            analyser_segment(carte.donnees, carte.taille, seg);
+        }
+
+        const std::string texte = seg.rapport.str();
+        etat.texte.dest->write(texte.data(), static_cast<std::streamsize>(texte.size()));
+        if (etat.colonnes != nullptr) {
+            ajouter_lots_gardes(*etat.colonnes, *seg.colonnes);
+        }
+        fusionner_statistiques(etat.stats, seg.etat.stats);
+    });
+
+    // Les trames à cheval sur deux segments rendent le bruit par segment
+    // approximatif ; au total, tout octet hors trame est du bruit.
+    etat.stats.octets_bruit = etat.stats.octets_lus -
+                              etat.stats.trames_valides * taille_trame(etat.format);
+}
 
 // ============================================================================
-// Fonctions de conversion
+// Index de recherche (--from-seq, --to-seq, --only-alert-blocks)
 // ============================================================================
+//
+// Pour examiner un incident sans relire toute la capture, un index creux est
+// construit au premier usage et gardé à côté d'elle (capture.bin.idx). Toutes
+// les PAS_INDEX trames retenues (mêmes règles de sync que l'analyse), il note
+// la position de la trame, sa séquence déroulée (sans retour à 0, voir
+// SuiviSequence) et le plus fort courant du bloc qu'elle ouvre. Une requête
+// ne lit ensuite que les blocs utiles, comme des segments de l'analyse
+// parallèle. Tous les entiers sont en little-endian.
+//
+//   En-tête : "TLMI", u16 version, u16 format (bit 0 : trames v2, octet de
+//             poids fort : nombre d'axes), u32 PAS_INDEX,
+//             u64 taille de la capture, u64 date de modification (ns),
+//             u64 nb_blocs
+//   Bloc    : u64 position, u64 séquence déroulée, u32 nb_trames,
+//             u16 courant max (mA, tous axes), u16 0
+//
+// L'index n'est réutilisé que si la taille, la date et le format de la
+// capture correspondent ; sinon il est reconstruit.
 
-/**
- * @brief Convertit une position brute en degrés
- * @param brut Valeur brute en centièmes de degré (int16_t)
- * @return Position en degrés (float)
- */
-float position_en_degres(int16_t brut) {
-    // TODO: Implémenter la conversion
+const size_t PAS_INDEX = 1024;
+const uint16_t VERSION_INDEX = 2;
+const size_t TAILLE_ENTETE_INDEX = 36;
+const size_t TAILLE_BLOC_INDEX = 24;
 
-    float posDegre = (brut/100.0f);
+struct BlocRecherche {
+    uint64_t position;      // Première trame du bloc
+    uint64_t sequence;      // Séquence déroulée de cette trame
+    uint32_t nb;            // Trames du bloc
+    uint16_t courant_max;   // mA, tous axes confondus
+};
 
-    return posDegre;
-}
+struct IndexRecherche {
+    uint64_t taille = 0;
+    uint64_t date = 0;
+    FormatTrame format;
+    std::vector<BlocRecherche> blocs;
+};
 
 /**
- * @brief Convertit une vitesse brute en degrés par seconde
- * @param brut Valeur brute en dixièmes de degré/seconde (int16_t)
- * @return Vitesse en degrés/seconde (float)
+ * @brief Position de la prochaine trame retenue à partir de @p pos
+ *
+ * Mêmes règles que analyser_segment() : sync confirmé, puis CRC en v2.
+ *
+ * @return Position de la trame, ou AUCUNE_POSITION
  */
-float vitesse_en_deg_s(int16_t brut) {
-    // TODO: Implémenter la conversion
-    float vitDegS= (brut/10.0f);
-    return vitDegS;
+size_t prochaine_trame(const uint8_t* donnees, size_t taille, size_t pos,
+                       const FormatTrame& format) {
+    const size_t pas = taille_trame(format);
+    while (pos < taille) {
+        size_t idx = chercher_sync(donnees, taille, pos);
+        if (idx == AUCUNE_POSITION || idx + pas > taille) {
+            break;
+        }
+        if (confirmer_sync(donnees, taille, idx, pas, true) == SYNC_ECARTE) {
+            pos = idx + 1;
+        } else if (!trame_acceptee(VueTrame{donnees + idx}, format)) {
+            pos = idx + pas;
+        } else {
+            return idx;
+        }
+    }
+    return AUCUNE_POSITION;
 }
 
 /**
- * @brief Convertit un courant brut en ampères
- * @param brut Valeur brute en milliampères (uint16_t)
- * @return Courant en ampères (float)
+ * @brief Séquence déroulée de la trame la plus avancée vue par le suivi
  */
-float courant_en_amperes(uint16_t brut) {
-    // TODO: Implémenter la conversion
-    float courAmp = brut/1000.0f;
-    return courAmp;
+inline uint64_t sequence_deroulee(const SuiviSequence& suivi) {
+    return suivi.premiere + suivi.index;
 }
 
-// ============================================================================
-// Fonctions de détection et décodage
-// ============================================================================
-
 /**
- * @brief Recherche les octets de synchronisation dans un tampon
- * 
- * Parcourt le tampon à partir de la position donnée et recherche la séquence
- * de synchronisation (0xAA 0x55). Retourne la position du premier octet de
- * sync si trouvé, ou -1 si non trouvé.
- * 
- * @param buffer Pointeur vers le tampon de données
- * @param taille Taille du tampon en octets
- * @param debut Position de départ pour la recherche
- * @return Position de la séquence de sync, ou -1 si non trouvée
+ * @brief Construit l'index d'une capture par un parcours complet
  */
-int trouver_sync(const uint8_t* buffer, size_t taille, size_t debut) {
-    // TODO: Implémenter la recherche des octets de synchronisation
-    // Attention à ne pas dépasser les limites du tampon!
-
-    for (int i = debut; i < taille; i++) {
+void construire_index(const FichierMappe& carte, IndexRecherche& index) {
+    const FormatTrame& format = index.format;
+    const size_t pas = taille_trame(format);
+    SuiviSequence suivi;
+    index.blocs.clear();
+    size_t pos = 0;
+    for (;;) {
+        size_t idx = prochaine_trame(carte.donnees, carte.taille, pos, format);
+        if (idx == AUCUNE_POSITION) {
+            break;
+        }
+        VueTrame trame{carte.donnees + idx};
+        suivre_sequence(suivi, trame.sequence());
+        if (index.blocs.empty() || index.blocs.back().nb == PAS_INDEX) {
+            index.blocs.push_back({idx, sequence_deroulee(suivi), 0, 0});
+        }
+        BlocRecherche& bloc = index.blocs.back();
+        bloc.nb++;
+        for (size_t i = 0; i < format.nb_axes; i++) {
+            bloc.courant_max = std::max(bloc.courant_max, trame.axe(i).courant());
+        }
+        pos = idx + pas;
+    }
+}
 
-        if (buffer [i] == SYNC_H && buffer[i+1] == SYNC_L){
+/**
+ * @brief Format des trames tel que noté dans l'en-tête de l'index
+ */
+inline uint16_t code_format_index(const FormatTrame& format) {
+    return static_cast<uint16_t>(format.nb_axes << 8 | (format.crc ? 1u : 0u));
+}
 
-            return i;
+/**
+ * @brief Relit un index ; false s'il est absent, illisible ou périmé
+ */
+bool lire_index(const std::string& nom, IndexRecherche& index) {
+    FichierMappe carte;
+    if (!mapper_fichier(carte, nom)) {
+        return false;
+    }
+    const uint8_t* d = carte.donnees;
+    bool ok = carte.taille >= TAILLE_ENTETE_INDEX && std::memcmp(d, "TLMI", 4) == 0 &&
+              lire_u16_le(d + 4) == VERSION_INDEX &&
+              lire_u16_le(d + 6) == code_format_index(index.format) &&
+              lire_u32_le(d + 8) == PAS_INDEX &&
+              lire_u64_le(d + 12) == index.taille && lire_u64_le(d + 20) == index.date;
+    uint64_t nb = ok ? lire_u64_le(d + 28) : 0;
+    ok = ok && (carte.taille - TAILLE_ENTETE_INDEX) / TAILLE_BLOC_INDEX == nb;
+    if (ok) {
+        index.blocs.resize(nb);
+        for (size_t b = 0; b < nb; b++) {
+            const uint8_t* e = d + TAILLE_ENTETE_INDEX + b * TAILLE_BLOC_INDEX;
+            index.blocs[b] = {lire_u64_le(e), lire_u64_le(e + 8), lire_u32_le(e + 16),
+                              lire_u16_le(e + 20)};
         }
-  
     }
-    return -1;
-    
+    liberer_fichier(carte);
+    return ok;
 }
 
 /**
- * @brief Vérifie si une trame est valide
- * 
- * Une trame est considérée valide si ses octets de synchronisation sont
- * corrects. (0xAA et 0x55)
- * 
- * @param trame Pointeur vers la trame à vérifier
- * @return true si la trame est valide, false sinon
+ * @brief Écrit l'index à côté de la capture
  */
-bool trame_valide(const Trame* trame) {
-    // TODO: Implémenter la vérification de validité
-    if (trame->sync1 == 0xAA && trame->sync2 == 0x55 && sizeof(trame)==39){
-        return true;
+bool ecrire_index(const std::string& nom, const IndexRecherche& index) {
+    std::string octets;
+    octets.append("TLMI", 4);
+    ajouter_le(octets, VERSION_INDEX, 2);
+    ajouter_le(octets, code_format_index(index.format), 2);
+    ajouter_le(octets, PAS_INDEX, 4);
+    ajouter_le(octets, index.taille, 8);
+    ajouter_le(octets, index.date, 8);
+    ajouter_le(octets, index.blocs.size(), 8);
+    for (const BlocRecherche& bloc : index.blocs) {
+        ajouter_le(octets, bloc.position, 8);
+        ajouter_le(octets, bloc.sequence, 8);
+        ajouter_le(octets, bloc.nb, 4);
+        ajouter_le(octets, bloc.courant_max, 2);
+        ajouter_le(octets, 0, 2);
     }
-    else {
+    std::ofstream sortie(nom, std::ios::binary);
+    sortie.write(octets.data(), static_cast<std::streamsize>(octets.size()));
+    return static_cast<bool>(sortie);
+}
 
+/**
+ * @brief Charge l'index de la capture, ou le construit et le met en cache
+ * @return false si la capture ne peut être examinée (stat(2))
+ */
+bool charger_index(const std::string& capture, const FichierMappe& carte,
+                   const FormatTrame& format, IndexRecherche& index) {
+    struct stat info;
+    if (stat(capture.c_str(), &info) != 0) {
+        std::cerr << "Erreur: " << capture << " : " << std::strerror(errno) << "\n";
         return false;
     }
+    index.taille = carte.taille;
+    index.date = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull +
+                 static_cast<uint64_t>(info.st_mtim.tv_nsec);
+    index.format = format;
 
-    
+    const std::string nom = capture + ".idx";
+    if (lire_index(nom, index)) {
+        return true;
+    }
+    construire_index(carte, index);
+    if (!ecrire_index(nom, index)) {
+        std::cerr << "Note: index non enregistré (" << nom << ")\n";
+    }
+    return true;
 }
 
 /**
- * @brief Décode une trame depuis un tampon d'octets bruts
+ * @brief Position de la première trame de séquence déroulée >= @p cible
  *
- * Cette fonction extrait les données d'une trame à partir d'un pointeur
- * vers le tampon brut. Elle suppose que le pointeur pointe vers le début
- * d'une trame (premier octet de sync).
+ * Saute au dernier bloc qui commence avant la cible, puis avance trame par
+ * trame en déroulant la séquence comme suivre_sequence().
  *
- * @param buffer Pointeur vers le début de la trame dans le tampon
- * @param trame Structure où stocker les données décodées
- * @return true si le décodage a réussi, false sinon
+ * @return Position de la trame, ou taille de la capture si aucune
  */
-bool decoder_trame(const uint8_t* buffer, Trame& trame) {
-    // TODO: Implémenter le décodage de la trame
-    //
-    // Si vos structures sont bien définies et alignées, un simple
-    // transtypage peut suffire.
-    
-} 
+size_t chercher_sequence(const FichierMappe& carte, const IndexRecherche& index, uint64_t cible) {
+    auto bloc = std::upper_bound(index.blocs.begin(), index.blocs.end(), cible,
+                                 [](uint64_t c, const BlocRecherche& b) { return c < b.sequence; });
+    if (bloc == index.blocs.begin()) {
+        return index.blocs.empty() ? carte.taille : index.blocs.front().position;
+    }
+    --bloc;
+
+    const size_t pas = taille_trame(index.format);
+    uint64_t deroulee = bloc->sequence;
+    size_t idx = bloc->position;
+    uint8_t courante = carte.donnees[idx + 2];
+    while (deroulee < cible) {
+        idx = prochaine_trame(carte.donnees, carte.taille, idx + pas, index.format);
+        if (idx == AUCUNE_POSITION) {
+            return carte.taille;
+        }
+        int ecart = static_cast<int8_t>(static_cast<uint8_t>(carte.donnees[idx + 2] - courante));
+        if (ecart > 0) {
+            deroulee += static_cast<uint64_t>(ecart);
+            courante = carte.donnees[idx + 2];
+        }
+    }
+    return idx;
+}
+
+/**
+ * @brief Analyse les seules zones de la capture retenues par la requête
+ *
+ * La plage [de, a] de séquences déroulées est ramenée à des positions
+ * exactes ; avec @p alertes_seules, elle est restreinte aux blocs dont le
+ * courant max dépasse le seuil. Chaque zone contiguë est analysée comme un
+ * segment ; les zones étant disjointes, leur suivi de séquence est cumulé
+ * comme celui de flux distincts (les trames sautées ne sont pas perdues).
+ */
+void analyser_selection(const FichierMappe& carte, const IndexRecherche& index, uint64_t de,
+                        uint64_t a, bool alertes_seules, EtatAnalyse& etat) {
+    size_t debut = chercher_sequence(carte, index, de);
+    size_t fin = a == UINT64_MAX ? carte.taille : chercher_sequence(carte, index, a + 1);
+
+    // Zones [debut, fin) retenues, blocs d'alerte consécutifs fusionnés
+    std::vector<std::pair<size_t, size_t>> zones;
+    size_t nb_blocs = 0;
+    for (size_t b = 0; b < index.blocs.size(); b++) {
+        size_t bloc_debut = std::max<size_t>(index.blocs[b].position, debut);
+        size_t bloc_fin = std::min<size_t>(
+            b + 1 < index.blocs.size() ? index.blocs[b + 1].position : carte.taille, fin);
+        bool retenu = bloc_debut < bloc_fin &&
+                      (!alertes_seules || index.blocs[b].courant_max > etat.seuil_ma);
+        if (!retenu) {
+            continue;
+        }
+        nb_blocs++;
+        if (!zones.empty() && zones.back().second == bloc_debut) {
+            zones.back().second = bloc_fin;
+        } else {
+            zones.push_back({bloc_debut, bloc_fin});
+        }
+    }
+    std::cerr << "Index : " << nb_blocs << " blocs de " << PAS_INDEX << " trames lus sur "
+              << index.blocs.size() << ", en " << zones.size() << " zone(s)\n";
 
+    etat.stats.octets_lus = 0;
+    size_t candidats = 0;
+    for (const auto& zone : zones) {
+        Segment seg;
+        seg.debut = seg.entree = zone.first;
+        seg.fin = zone.second;
+        seg.premier_candidat = candidats;
+        seg.etat.seuil_ma = etat.seuil_ma;
+        seg.etat.format = etat.format;
+        seg.etat.mode = etat.mode;
+        seg.etat.intervalle = etat.intervalle;
+        seg.sortie = etat.texte.dest;
+        analyser_segment(carte.donnees, carte.taille, seg);
+        candidats = seg.etat.candidats;
+        ajouter_statistiques_flux(etat.stats, seg.etat.stats);
+    }
+    etat.stats.octets_bruit = etat.stats.octets_lus -
+                              etat.stats.trames_valides * taille_trame(etat.format);
+}
 
 // ============================================================================
-// Fonctions d'analyse
+// Analyse de plusieurs flux (--multi)
 // ============================================================================
+//
+// Chaque entrée (fichier, FIFO, stdin) garde son propre lecteur, son état
+// de synchronisation, ses statistiques et son suivi de séquence. Les flux
+// sont répartis à l'avance entre quelques fils ; chaque fil attend ses
+// descripteurs avec poll(2) et traite le bloc de tout flux prêt. Aucun état
+// n'est partagé entre fils.
+
+struct FluxEntree {
+    std::string nom;
+    LecteurFlux lecteur;
+    EtatAnalyse etat;
+};
 
 /**
- * @brief Vérifie si un axe est en alerte courant
- * @param axe Données de l'axe à vérifier
- * @param seuil Seuil de courant en ampères
- * @return true si le courant dépasse le seuil
+ * @brief Lit et traite un bloc d'un flux prêt
+ * @return false si le flux est terminé (fin ou erreur de lecture)
  */
-bool est_en_alerte(const DonneesAxe& axe, float seuil) {
-    // TODO: Implémenter la vérification d'alerte
-    if (axe.courant>seuil){
-        return true;
-    }
+bool avancer_flux(FluxEntree& flux) {
+    // Fin UDP reçue avec les derniers datagrammes : poll() ne signalerait plus rien
+    bool encore = lire_bloc(flux.lecteur, flux.etat.stats) && !flux.lecteur.fin_datagrammes;
+    size_t consommes = traiter_tampon(flux.lecteur.tampon.data(), flux.lecteur.taille,
+                                      !encore, flux.etat);
+    consommer_bloc(flux.lecteur, consommes);
+    return encore;
+}
 
-    else {
-        return false;
-    }
+/**
+ * @brief Termine un flux UDP silencieux : ses dernières trames sont traitées
+ */
+void abandonner_flux(FluxEntree& flux) {
+    constater_inactivite(flux.lecteur);
+    size_t consommes = traiter_tampon(flux.lecteur.tampon.data(), flux.lecteur.taille, true,
+                                      flux.etat);
+    consommer_bloc(flux.lecteur, consommes);
+}
+
+/**
+ * @brief Boucle d'un fil : sert ses flux jusqu'à ce qu'ils soient tous terminés
+ *
+ * poll() n'attend pas plus longtemps que le plus court délai d'inactivité
+ * restant, pour qu'un flux UDP dont la marque de fin s'est perdue se termine.
+ */
+void servir_flux(std::vector<FluxEntree*> actifs) {
+    declarer_fil_metriques("flux");
+    std::vector<pollfd> attente(actifs.size());
+    RegimeAllocations regime;
+    while (!actifs.empty()) {
+        attente.resize(actifs.size());
+        int delai = -1;
+        for (size_t k = 0; k < actifs.size(); k++) {
+            attente[k].fd = actifs[k]->lecteur.fd;
+            attente[k].events = POLLIN;
+            attente[k].revents = 0;
+            int restant = delai_inactivite(actifs[k]->lecteur);
+            if (restant >= 0 && (delai < 0 || restant < delai)) {
+                delai = restant;
+            }
+        }
+        if (poll(attente.data(), attente.size(), delai) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Erreur poll : " << std::strerror(errno) << "\n";
+            return;
+        }
 
+        size_t restants = 0;
+        for (size_t k = 0; k < actifs.size(); k++) {
+            bool pret = (attente[k].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+            if (!pret && delai_inactivite(actifs[k]->lecteur) == 0) {
+                abandonner_flux(*actifs[k]);
+            } else if (!pret || avancer_flux(*actifs[k])) {
+                actifs[restants++] = actifs[k];
+            }
+        }
+        actifs.resize(restants);
+    }
 }
 
 /**
- * @brief Analyse une trame et met à jour les statistiques
- * @param trame Trame à analyser
- * @param stats Statistiques à mettre à jour
- * @param seuil Seuil de courant pour les alertes
- * @return true si la trame contient au moins une alerte
+ * @brief Analyse tous les flux sur nb_fils fils, puis écrit leurs statistiques
+ *
+ * Un bloc de statistiques par flux, dans l'ordre des arguments, puis le
+ * résumé de l'ensemble (les séquences de flux différents ne s'enchaînent
+ * pas, voir cumuler_suivi()).
  */
-bool analyser_trame(const Trame& trame, Statistiques& stats, float seuil) {
-    // Mettre à jour les statistiques de séquence
+void analyser_plusieurs_flux(std::vector<std::unique_ptr<FluxEntree>>& flux, size_t nb_fils,
+                             std::ostream& sortie) {
+    nb_fils = std::max<size_t>(1, std::min(nb_fils, flux.size()));
+    std::vector<std::vector<FluxEntree*>> repartition(nb_fils);
+    for (size_t k = 0; k < flux.size(); k++) {
+        repartition[k % nb_fils].push_back(flux[k].get());
+    }
 
-    // TODO: Vérifier si la séquence est bonne avec sequence_min et sequence_max
-    // TODO: Vérifier si un axe est en alerte et retourner le résultat
+    std::vector<std::thread> fils;
+    for (size_t f = 1; f < nb_fils; f++) {
+        fils.emplace_back(servir_flux, repartition[f]);
+    }
+    servir_flux(repartition[0]);
+    for (auto& f : fils) {
+        f.join();
+    }
 
-    
-    return false;
+    Statistiques total;
+    for (auto& f : flux) {
+        sortie << "Flux : " << f->nom << "\n";
+        ecrire_statistiques(sortie, f->etat.stats);
+        sortie << "\n";
+        ajouter_statistiques_flux(total, f->etat.stats);
+    }
+    sortie << "Ensemble des " << flux.size() << " flux\n";
+    ecrire_statistiques(sortie, total);
 }
 
 // ============================================================================
-// Fonctions d'entrée/sortie
+// Banc d'essai (--bench)
 // ============================================================================
+//
+// Chaque étape de la chaîne est chronométrée seule sur une capture projetée,
+// lot de TAILLE_LOT trames par lot : recherche de sync (avec validation)
+// jusqu'à TAILLE_LOT trames, décodage en colonnes, analyse du lot, mise en
+// forme du rapport ; puis la chaîne complète (traiter_tampon(), par fenêtre
+// de TAILLE_FENETRE_CARTE). Le débit en Go/s est rapporté à la taille de la
+// capture. Une ligne JSON par étape, pour comparer deux versions.
+//
+// Une trame se traite en quelques ns, moins que la lecture de l'horloge :
+// les percentiles portent sur la durée d'un lot complet (lot_p50_ns,
+// lot_p99_ns), pas d'une trame. La chaîne complète, mesurée par fenêtre,
+// n'en a pas (null).
+
+struct MesureEtape {
+    const char* nom = "";
+    uint64_t trames = 0;
+    uint64_t ns = 0;
+    std::vector<double> ns_par_lot;     // Durée de chaque lot complet
+};
 
 /**
- * @brief Lit les données depuis un fichier ou stdin dans un vecteur
- * @param source Nom du fichier ou "-" pour stdin
- * @return Vecteur contenant les octets lus
+ * @brief Ajoute la durée d'un lot à une étape
+ *
+ * Seuls les lots complets (TAILLE_LOT trames) entrent dans les percentiles.
  */
-std::vector<uint8_t> lire_donnees(const std::string &source) {
-    std::vector<uint8_t> buffer;
-    
-    if (source == "-") {
-        int c;
-        while (!std::cin.eof()){
-            c= std::cin.get();
-            buffer.push_back(static_cast<uint8_t>(c));  
-        }
-    return buffer;
-        // Lecture depuis stdin
-        // TODO: Lire tous les octets de std::cin dans le buffer
-        //
-        // INDICES:
-        // - Utiliser std::cin.get() pour lire octet par octet
-        // - Ou lire par blocs dans un tampon temporaire
-        // - Arrêter quand std::cin.eof() est vrai
-        
+void mesurer_lot(MesureEtape& etape, uint64_t debut, uint64_t fin, size_t trames) {
+    etape.trames += trames;
+    etape.ns += fin - debut;
+    if (trames == TAILLE_LOT) {
+        etape.ns_par_lot.push_back(static_cast<double>(fin - debut));
+    }
+}
 
-    } 
-    else {
-        std::ifstream fichier("donnees.bin", std::ios::binary);
-        if (!fichier.is_open()) {
-            std::cerr << "Erreur : impossible d'ouvrir le fichier" << std::endl;
-            return {};
-        }
-        if (fichier.is_open()) {
-            std::cout << " Ficher Ouvert" << std::endl;
-            fichier.seekg(0, std::ios::end);        // Aller à la fin
-            size_t taille = fichier.tellg();        // Position = taille
-            fichier.seekg(0, std::ios::beg);        // Revenir au début
-        }
-        buffer.resize(taille);      // changer la taille du buffer pour corresponde aux fichier "donnees.bin"
-        fichier.read(reinterpret_cast<char*>(buffer.data()), taille);       // transcrire ficher dans buffer
-        return buffer; 
-        
-        // Lecture depuis un fichier
-        // TODO: Ouvrir le fichier en mode binaire et lire son contenu
-        //
-        // INDICES:
-        // - std::ifstream fichier(source, std::ios::binary) - DONE
-        // - Vérifier que le fichier est ouvert avec is_open() - DONE
-        // - Déterminer la taille avec seekg/tellg - DONE
-        // - Redimensionner le buffer et lire avec read() - DONE
-        
+/**
+ * @brief Écrit une chaîne JSON entre guillemets (le nom de fichier est libre)
+ *
+ * '"', '\\' et les caractères de contrôle sont échappés ; les autres octets,
+ * UTF-8 compris, sont recopiés.
+ */
+void ecrire_chaine_json(std::ostream& sortie, const std::string& texte) {
+    static const char chiffres[] = "0123456789abcdef";
+    sortie << '"';
+    for (char c : texte) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            sortie << '\\' << c;
+        } else if (c == '\n') {
+            sortie << "\\n";
+        } else if (c == '\t') {
+            sortie << "\\t";
+        } else if (u < 0x20 || u == 0x7f) {
+            sortie << "\\u00" << chiffres[u >> 4] << chiffres[u & 0xf];
+        } else {
+            sortie << c;
+        }
     }
-    
-    return buffer;
+    sortie << '"';
 }
 
 /**
- * @brief Écrit une ligne de rapport pour une trame
- * @param sortie Flux de sortie
- * @param trame Trame à rapporter
- * @param seuil Seuil pour les alertes
+ * @brief Écrit une étape mesurée en une ligne JSON
  */
-void ecrire_rapport_trame(std::ostream& sortie, const Trame& trame, float seuil) {
+void ecrire_mesure(std::ostream& sortie, const std::string& fichier, size_t octets,
+                   MesureEtape& etape) {
+    std::vector<double>& v = etape.ns_par_lot;
+    std::sort(v.begin(), v.end());
+    double secondes = static_cast<double>(etape.ns) / 1e9;
 
-    
-    for (size_t i = 0; i < NB_AXES; i++) {
-        // TODO: Écrire les données de chaque axe dans le format suivant:
-        //   "  Axe N: XXX.XX° | XXX.X°/s | X.XXX A [ALERTE]"
-        //
-        // INDICES:
-        // - Utiliser std::fixed et std::setprecision() pour le formatage
-        // - Ajouter "[!ALERTE!]" si le courant dépasse le seuil
-        
-        sortie << "  Axe " << (i + 1) << ": ";
-        
-        // TODO: Compléter l'affichage
-        
-        sortie << "\n";
+    sortie << "{\"fichier\":";
+    ecrire_chaine_json(sortie, fichier);
+    sortie << std::fixed << std::setprecision(3)
+           << ",\"etape\":\"" << etape.nom
+           << "\",\"trames\":" << etape.trames << ",\"octets\":" << octets
+           << ",\"secondes\":" << std::setprecision(6) << secondes
+           << ",\"trames_s\":" << std::setprecision(0)
+           << (secondes > 0 ? static_cast<double>(etape.trames) / secondes : 0.0)
+           << ",\"go_s\":" << std::setprecision(3)
+           << (etape.ns > 0 ? static_cast<double>(octets) / static_cast<double>(etape.ns) : 0.0)
+           << ",\"lot_p50_ns\":";
+    if (v.empty()) {
+        sortie << "null,\"lot_p99_ns\":null}\n";
+    } else {
+        sortie << std::setprecision(0) << v[v.size() / 2] << ",\"lot_p99_ns\":"
+               << v[std::min(v.size() - 1, v.size() * 99 / 100)] << "}\n";
     }
-    
-    sortie << "\n";
 }
 
 /**
- * @brief Écrit le résumé des statistiques
- * @param sortie Flux de sortie
- * @param stats Statistiques à afficher
+ * @brief Décode dans un lot vide les n trames repérées par leurs positions
  */
-void ecrire_statistiques(std::ostream& sortie, const Statistiques& stats) {
-    sortie << "========================================\n";
-    sortie << "STATISTIQUES\n";
-    sortie << "========================================\n";
-    sortie << "Octets lus          : " << stats.octets_lus << "\n";
-    sortie << "Octets de bruit     : " << stats.octets_bruit << "\n";
-    sortie << "Trames valides      : " << stats.trames_valides << "\n";
-    sortie << "Trames avec alerte  : " << stats.trames_alerte << "\n";
-    
-    if (stats.trames_valides > 0) {
-        sortie << "Séquence min        : " << static_cast<int>(stats.sequence_min) << "\n";
-        sortie << "Séquence max        : " << static_cast<int>(stats.sequence_max) << "\n";
-        
-        // TODO: Calculer et afficher le nombre de trames potentiellement perdues
-        //       basé sur les numéros de séquence (attention au wrap-around de 255 à 0)
+template <size_t Axes>
+void decoder_positions(LotTrames& lot, const uint8_t* donnees, const size_t* positions, size_t n) {
+    lot.nb = 0;
+    lot.nb_axes = Axes;
+    for (size_t k = 0; k < n; k++) {
+        decoder_dans_lot<Axes>(lot, VueTrame{donnees + positions[k]});
+    }
+}
+
+/**
+ * @brief Chronomètre chaque étape sur une capture projetée
+ * @param carte Capture (par exemple produite par ./simulateur -n N -b p)
+ * @param seuil_ma Seuil d'alerte (voir seuil_en_milliamperes())
+ * @param format Modèle de bras et format v2 (--axes, --crc)
+ * @param nom Nom de la capture, repris dans les lignes JSON
+ * @param sortie Flux des lignes JSON
+ */
+void lancer_banc(const FichierMappe& carte, int32_t seuil_ma, const FormatTrame& format,
+                 const std::string& nom, std::ostream& sortie) {
+    std::ostream nul(nullptr);      // Rapport mis en forme puis jeté
+    const uint8_t* donnees = carte.donnees;
+    const size_t taille = carte.taille;
+
+    MesureEtape sync, decodage, analyse, mise_en_forme, chaine;
+    sync.nom = "sync";
+    decodage.nom = "decodage";
+    analyse.nom = "analyse";
+    mise_en_forme.nom = "mise_en_forme";
+    chaine.nom = "chaine";
+
+    // Recherche de sync : mêmes règles que traiter_tampon() ; les pages
+    // sont d'abord touchées une fois pour ne pas chronométrer les défauts.
+    volatile uint8_t cumul = 0;
+    for (size_t k = 0; k < taille; k += 4096) {
+        cumul = static_cast<uint8_t>(cumul + donnees[k]);
+    }
+    // Puis, lot par lot : recherche des positions de TAILLE_LOT trames,
+    // décodage, analyse et mise en forme (seules les positions du lot en
+    // cours sont gardées)
+    const size_t pas = taille_trame(format);
+    std::unique_ptr<LotTrames> lot(new LotTrames);
+    Statistiques stats;
+    TamponSortie texte;
+    texte.dest = &nul;
+    size_t positions[TAILLE_LOT];
+    size_t pos = 0;
+    bool fin_capture = false;
+    while (!fin_capture) {
+        size_t n = 0;
+        uint64_t t0 = horloge_ns();
+        while (n < TAILLE_LOT) {
+            size_t idx = pos < taille ? chercher_sync(donnees, taille, pos) : AUCUNE_POSITION;
+            if (idx == AUCUNE_POSITION || idx + pas > taille) {
+                fin_capture = true;
+                break;
+            }
+            if (confirmer_sync(donnees, taille, idx, pas, true) == SYNC_ECARTE) {
+                pos = idx + 1;
+                continue;
+            }
+            if (trame_acceptee(VueTrame{donnees + idx}, format)) {
+                positions[n++] = idx;
+            }
+            pos = idx + pas;
+        }
+        uint64_t t1 = horloge_ns();
+        if (format.nb_axes == NB_AXES_COBOT) {
+            decoder_positions<NB_AXES_COBOT>(*lot, donnees, positions, n);
+        } else {
+            decoder_positions<NB_AXES_BRAS>(*lot, donnees, positions, n);
+        }
+        uint64_t t2 = horloge_ns();
+        analyser_lot(*lot, stats, seuil_ma);
+        uint64_t t3 = horloge_ns();
+        for (size_t k = 0; k < n; k++) {
+            ecrire_trame_lot(texte, *lot, k);
+        }
+        uint64_t t4 = horloge_ns();
+
+        mesurer_lot(sync, t0, t1, n);
+        mesurer_lot(decodage, t1, t2, n);
+        mesurer_lot(analyse, t2, t3, n);
+        mesurer_lot(mise_en_forme, t3, t4, n);
+    }
+    vider_sortie(texte);
+
+    // Chaîne complète, rapport compris
+    EtatAnalyse etat;
+    etat.seuil_ma = seuil_ma;
+    etat.format = format;
+    etat.texte.dest = &nul;
+    pos = 0;
+    while (pos < taille) {
+        size_t fenetre = std::min(TAILLE_FENETRE_CARTE, taille - pos);
+        size_t avant = etat.stats.trames_valides;
+        uint64_t t0 = horloge_ns();
+        pos += traiter_tampon(donnees + pos, fenetre, pos + fenetre == taille, etat);
+        vider_sortie(etat.texte);
+        chaine.trames += etat.stats.trames_valides - avant;
+        chaine.ns += horloge_ns() - t0;
+    }
+
+    for (MesureEtape* etape : {&sync, &decodage, &analyse, &mise_en_forme, &chaine}) {
+        ecrire_mesure(sortie, nom, taille, *etape);
     }
-    
-    sortie << "========================================\n";
 }
 
 // ============================================================================
 // Fonction principale
 // ============================================================================
 
+/**
+ * @brief Lit un seuil de courant en ampères (argument ou --threshold)
+ * @return false (message sur stderr) si le texte n'est pas un nombre
+ */
+bool lire_seuil(const std::string& texte, float& seuil) {
+    try {
+        seuil = std::stof(texte);
+    } catch (...) {
+        std::cerr << "Erreur: seuil de courant invalide\n";
+        return false;
+    }
+    return true;
+}
+
 void afficher_aide(const char* prog) {
-    std::cerr << "Usage: " << prog << " <fichier_entree> [fichier_sortie] [seuil_courant]\n";
+    std::cerr << "Usage: " << prog << " [options] <fichier_entree> [fichier_sortie] [seuil_courant]\n";
+    std::cerr << "       " << prog << " --multi [-j n] [--threshold A] <entree>...\n";
     std::cerr << "\n";
     std::cerr << "Arguments:\n";
-    std::cerr << "  fichier_entree   Fichier binaire ou '-' pour stdin\n";
+    std::cerr << "  fichier_entree   Fichier binaire, '-' pour stdin, ou écoute réseau :\n";
+    std::cerr << "                   udp:[hôte:]port (datagrammes de trames) ou tcp:[hôte:]port\n";
     std::cerr << "  fichier_sortie   Fichier de rapport (défaut: stdout)\n";
     std::cerr << "  seuil_courant    Seuil d'alerte en ampères (défaut: 5.0)\n";
     std::cerr << "\n";
+    std::cerr << "Options:\n";
+    std::cerr << "  -j <n>           Analyse un fichier sur n fils (défaut: 1)\n";
+    std::cerr << "  --multi          Analyse chaque argument comme un flux distinct (fichier,\n";
+    std::cerr << "                   FIFO, '-') sur -j fils, puis statistiques par flux et totales\n";
+    std::cerr << "  --threshold <A>  Seuil d'alerte en ampères, au lieu de seuil_courant (seule\n";
+    std::cerr << "                   façon de le fixer avec --multi)\n";
+    std::cerr << "  --crc            Trames au format v2 (suivies d'un CRC-32C, ./simulateur --crc)\n";
+    std::cerr << "  --axes <n>       Modèle de bras : 6 axes (défaut) ou 7 (cobot, ./simulateur --axes 7)\n";
+    std::cerr << "  --from-seq <n>   N'analyse que les trames de séquence déroulée >= n (index .idx)\n";
+    std::cerr << "  --to-seq <n>     N'analyse que les trames de séquence déroulée <= n (index .idx)\n";
+    std::cerr << "  --only-alert-blocks  N'analyse que les blocs de l'index où le seuil est dépassé\n";
+    std::cerr << "  --summary        N'écrit que les statistiques\n";
+    std::cerr << "  --alerts-only    N'écrit que les trames en alerte\n";
+    std::cerr << "  --every <n>      N'écrit qu'une trame sur n (parmi celles rapportées)\n";
+    std::cerr << "  --columns <f>    Écrit aussi les trames décodées en colonnes binaires dans f\n";
+    std::cerr << "  --windows        Émet chaque seconde les moyennes sur 1 s, 10 s et 60 s\n";
+    std::cerr << "  --rate <hz>      Fréquence des trames pour --windows (défaut: 100)\n";
+    std::cerr << "  --bench          Chronomètre chaque étape sur le fichier (lignes JSON)\n";
+    std::cerr << "  --no-pipeline    En flux, lit, analyse et écrit sur un seul fil\n";
+    std::cerr << "  --idle <s>       Termine une entrée udp: après s secondes sans datagramme,\n";
+    std::cerr << "                   une fois le flux commencé (défaut: 5, 0 : jamais)\n";
+    std::cerr << "  --pin <l,a,r>    Épingle les fils lecture, analyse, rédaction sur ces cœurs\n";
+    std::cerr << "  --pipeline-stats Écrit sur stderr les attentes entre étages du pipeline\n";
+    std::cerr << "  --metrics <f>    Écrit périodiquement les compteurs par fil dans f (format\n";
+    std::cerr << "                   Prometheus) ou sur stderr avec '-' (make METRIQUES=1)\n";
+    std::cerr << "  --metrics-every <s>  Période d'écriture de --metrics (défaut: 1 s)\n";
+    std::cerr << "  --events         Remplace les trames par les surintensités soutenues par axe\n";
+    std::cerr << "  --min-frames <n> Durée minimale d'une surintensité, en trames (défaut: 5)\n";
+    std::cerr << "\n";
     std::cerr << "Exemples:\n";
     std::cerr << "  " << prog << " donnees.bin\n";
     std::cerr << "  " << prog << " donnees.bin rapport.txt 4.5\n";
+    std::cerr << "  " << prog << " -j 8 capture.bin rapport.txt\n";
     std::cerr << "  ./simulateur | " << prog << " - rapport.txt\n";
+    std::cerr << "  ./simulateur -r | " << prog << " --summary --windows -\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -361,39 +4385,277 @@ int main(int argc, char* argv[]) {
     // Analyse des arguments
     // ========================================================================
     
-    if (argc < 2) {
+    std::vector<std::string> positionnels;
+    size_t nb_fils = 1;
+    ModeRapport mode = RAPPORT_COMPLET;
+    size_t intervalle = 1;
+    std::string seuil_option;       // --threshold, sinon seuil_courant positionnel
+    std::string fichier_colonnes;
+    bool fenetres_actives = false;
+    bool evenements_actifs = false;
+    size_t duree_min = DUREE_MIN_SURINTENSITE;
+    bool pipeline = true;
+    bool banc = false;
+    bool multi = false;
+    bool fils_fixes = false;
+    FormatTrame format;
+    uint64_t sequence_de = 0;
+    uint64_t sequence_a = UINT64_MAX;
+    bool alertes_seules = false;
+    bool recherche = false;         // --from-seq, --to-seq ou --only-alert-blocks
+    bool metriques_pipeline = false;
+    DiffuseurMetriques metriques;
+    CoeursPipeline coeurs;
+    float frequence = 100.0f;       // Hz, celle du simulateur (-f)
+    int inactivite_ms = 5000;       // Silence qui termine une entrée udp: (--idle)
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            int n = std::atoi(argv[++i]);
+            if (n < 1) {
+                std::cerr << "Erreur: nombre de fils invalide\n";
+                return 1;
+            }
+            nb_fils = static_cast<size_t>(n);
+            fils_fixes = true;
+        } else if (strcmp(argv[i], "--multi") == 0) {
+            multi = true;
+        } else if (strcmp(argv[i], "--crc") == 0) {
+            format.crc = true;
+        } else if (strcmp(argv[i], "--axes") == 0 && i + 1 < argc) {
+            int n = std::atoi(argv[++i]);
+            if (n < 0 || !nb_axes_pris_en_charge(static_cast<size_t>(n))) {
+                std::cerr << "Erreur: --axes attend " << NB_AXES_BRAS << " ou " << NB_AXES_COBOT << "\n";
+                return 1;
+            }
+            format.nb_axes = static_cast<size_t>(n);
+        } else if (strcmp(argv[i], "--from-seq") == 0 && i + 1 < argc) {
+            sequence_de = std::strtoull(argv[++i], nullptr, 10);
+            recherche = true;
+        } else if (strcmp(argv[i], "--to-seq") == 0 && i + 1 < argc) {
+            sequence_a = std::strtoull(argv[++i], nullptr, 10);
+            recherche = true;
+        } else if (strcmp(argv[i], "--only-alert-blocks") == 0) {
+            alertes_seules = true;
+            recherche = true;
+        } else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) {
+            fichier_colonnes = argv[++i];
+        } else if (strcmp(argv[i], "--windows") == 0) {
+            fenetres_actives = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            banc = true;
+        } else if (strcmp(argv[i], "--no-pipeline") == 0) {
+            pipeline = false;
+        } else if (strcmp(argv[i], "--pipeline-stats") == 0) {
+            metriques_pipeline = true;
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metriques.destination = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-every") == 0 && i + 1 < argc) {
+            metriques.periode_s = std::atof(argv[++i]);
+            if (metriques.periode_s <= 0.0) {
+                std::cerr << "Erreur: période de métriques invalide\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--idle") == 0 && i + 1 < argc) {
+            double s = std::atof(argv[++i]);
+            if (s < 0.0) {
+                std::cerr << "Erreur: délai d'inactivité invalide\n";
+                return 1;
+            }
+            inactivite_ms = static_cast<int>(s * 1000.0);
+        } else if (strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%d,%d,%d", &coeurs.lecture, &coeurs.analyse,
+                            &coeurs.redaction) != 3) {
+                std::cerr << "Erreur: --pin attend trois cœurs (lecture,analyse,rédaction)\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--events") == 0) {
+            evenements_actifs = true;
+        } else if (strcmp(argv[i], "--min-frames") == 0 && i + 1 < argc) {
+            int n = std::atoi(argv[++i]);
+            if (n < 1) {
+                std::cerr << "Erreur: durée minimale invalide\n";
+                return 1;
+            }
+            duree_min = static_cast<size_t>(n);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            frequence = std::atof(argv[++i]);
+            if (frequence < 1.0f) {
+                std::cerr << "Erreur: fréquence invalide\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            seuil_option = argv[++i];
+        } else if (strcmp(argv[i], "--summary") == 0) {
+            mode = RAPPORT_RESUME;
+        } else if (strcmp(argv[i], "--alerts-only") == 0) {
+            mode = RAPPORT_ALERTES;
+        } else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            int n = std::atoi(argv[++i]);
+            if (n < 1) {
+                std::cerr << "Erreur: intervalle invalide\n";
+                return 1;
+            }
+            intervalle = static_cast<size_t>(n);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            std::cerr << "Option inconnue: " << argv[i] << "\n";
+            afficher_aide(argv[0]);
+            return 1;
+        } else {
+            positionnels.push_back(argv[i]);
+        }
+    }
+    
+    if (!metriques.destination.empty()) {
+        if (!ANALYSEUR_METRIQUES) {
+            std::cerr << "Erreur: --metrics exige un analyseur compilé avec make METRIQUES=1\n";
+            return 1;
+        }
+        declarer_fil_metriques("principal");
+        demarrer_metriques(metriques);
+    }
+    
+    if (multi) {
+        if (positionnels.empty()) {
+            afficher_aide(argv[0]);
+            return 1;
+        }
+        // Options sans effet sur l'analyse par poll() des flux : refusées
+        bool epinglage = coeurs.lecture >= 0 || coeurs.analyse >= 0 || coeurs.redaction >= 0;
+        if (!fichier_colonnes.empty() || fenetres_actives || evenements_actifs || banc ||
+            mode == RAPPORT_ALERTES || intervalle != 1 || recherche || epinglage ||
+            metriques_pipeline || !pipeline) {
+            std::cerr << "Erreur: --multi n'écrit que les statistiques (sans --columns, "
+                         "--windows, --events, --bench, --alerts-only, --every, --from-seq, "
+                         "--to-seq, --only-alert-blocks, --pin, --pipeline-stats ni "
+                         "--no-pipeline)\n";
+            return 1;
+        }
+        
+        // Tous les arguments sont des entrées : le seuil vient de --threshold
+        float seuil_courant = 5.0f;
+        if (!seuil_option.empty() && !lire_seuil(seuil_option, seuil_courant)) {
+            return 1;
+        }
+        int32_t seuil_ma = seuil_en_milliamperes(seuil_courant);
+        std::vector<std::unique_ptr<FluxEntree>> flux;
+        for (const std::string& source : positionnels) {
+            std::unique_ptr<FluxEntree> f(new FluxEntree);
+            f->nom = source;
+            f->lecteur.inactivite_ms = inactivite_ms;
+            if (!ouvrir_flux(f->lecteur, source)) {
+                for (auto& ouvert : flux) {
+                    fermer_flux(ouvert->lecteur);
+                }
+                return 1;
+            }
+            f->etat.seuil_ma = seuil_ma;
+            f->etat.mode = RAPPORT_RESUME;
+            f->etat.format = format;
+            flux.push_back(std::move(f));
+        }
+        
+        size_t nb_travailleurs = fils_fixes ? nb_fils
+            : std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Analyse de télémétrie - " << flux.size()
+                  << " flux - Seuil d'alerte: " << seuil_courant << " A\n";
+        std::cout << "========================================\n\n";
+        analyser_plusieurs_flux(flux, nb_travailleurs, std::cout);
+        for (auto& f : flux) {
+            fermer_flux(f->lecteur);
+        }
+        verifier_allocations();
+        return 0;
+    }
+    
+    if (positionnels.empty() || positionnels.size() > 3) {
         afficher_aide(argv[0]);
         return 1;
     }
     
-    std::string fichier_entree = argv[1];
+    std::string fichier_entree = positionnels[0];
     std::string fichier_sortie = "";  // Vide = stdout
     float seuil_courant = 5.0f;       // Ampères
     
-    if (argc >= 3) {
-        fichier_sortie = argv[2];
-    }
-    if (argc >= 4) {
-        try {
-            seuil_courant = std::stof(argv[3]);
-        } catch (...) {
-            std::cerr << "Erreur: seuil de courant invalide\n";
-            return 1;
-        }
+    if (positionnels.size() >= 2) {
+        fichier_sortie = positionnels[1];
+    }
+    if (positionnels.size() >= 3 && !seuil_option.empty()) {
+        std::cerr << "Erreur: seuil donné deux fois (--threshold et seuil_courant)\n";
+        return 1;
+    }
+    if (positionnels.size() >= 3) {
+        seuil_option = positionnels[2];
+    }
+    if (!seuil_option.empty() && !lire_seuil(seuil_option, seuil_courant)) {
+        return 1;
     }
 
-    std::cout << buffer <<
-    
     // ========================================================================
-    // Lecture des données
+    // Ouverture de l'entrée
     // ========================================================================
+    //
+    // Un fichier régulier est projeté en mémoire ; stdin, les pipes et tout
+    // échec de mmap passent par la lecture par blocs (mémoire constante).
     
-    std::vector<uint8_t> buffer = lire_donnees(fichier_entree);
+    EtatAnalyse etat;
+    Statistiques& stats = etat.stats;
     
-    if (buffer.empty()) {
-        std::cerr << "Erreur: aucune donnée lue\n";
+    // Seuil converti une seule fois en milliampères entiers
+    etat.seuil_ma = seuil_en_milliamperes(seuil_courant);
+    etat.mode = mode;
+    etat.intervalle = intervalle;
+    etat.format = format;
+    
+    FichierMappe carte;
+    LecteurFlux lecteur;
+    bool mappe = fichier_entree != "-" && !est_adresse_reseau(fichier_entree) &&
+                 mapper_fichier(carte, fichier_entree);
+    bool conteneur = mappe && est_conteneur(carte.donnees, carte.taille);
+    bool encore = false;
+    
+    if (recherche && (!mappe || conteneur || banc || !fichier_colonnes.empty() ||
+                      fenetres_actives || evenements_actifs)) {
+        std::cerr << "Erreur: --from-seq, --to-seq et --only-alert-blocks exigent une capture "
+                     "brute en fichier régulier (sans --columns, --windows, --events ni --bench)\n";
+        liberer_fichier(carte);
+        return 1;
+    }
+    if (banc && conteneur) {
+        std::cerr << "Erreur: --bench mesure une capture brute, pas un conteneur compressé\n";
+        liberer_fichier(carte);
         return 1;
     }
+    if (banc) {
+        if (!mappe) {
+            std::cerr << "Erreur: --bench exige un fichier régulier non vide\n";
+            return 1;
+        }
+        lancer_banc(carte, etat.seuil_ma, etat.format, fichier_entree, std::cout);
+        liberer_fichier(carte);
+        return 0;
+    }
+    
+    if (mappe) {
+        stats.octets_lus = carte.taille;
+    } else {
+        lecteur.inactivite_ms = inactivite_ms;
+        if (!ouvrir_flux(lecteur, fichier_entree)) {
+            return 1;
+        }
+        encore = lire_bloc(lecteur, stats);
+        
+        if (lecteur.taille == 0) {
+            std::cerr << "Erreur: aucune donnée lue\n";
+            fermer_flux(lecteur);
+            return 1;
+        }
+        if (est_conteneur(lecteur.tampon.data(), lecteur.taille)) {
+            std::cerr << "Erreur: un conteneur compressé se lit depuis un fichier régulier\n";
+            fermer_flux(lecteur);
+            return 1;
+        }
+    }
     
     // ========================================================================
     // Configuration de la sortie
@@ -406,38 +4668,132 @@ int main(int argc, char* argv[]) {
         fichier_out.open(fichier_sortie);
         if (!fichier_out.is_open()) {
             std::cerr << "Erreur: impossible de créer " << fichier_sortie << "\n";
+            liberer_fichier(carte);
+            fermer_flux(lecteur);
             return 1;
         }
         sortie = &fichier_out;
     }
+    etat.texte.dest = sortie;
+    
+    std::ofstream colonnes_out;
+    EcrivainColonnes colonnes;
+    if (!fichier_colonnes.empty()) {
+        colonnes_out.open(fichier_colonnes, std::ios::binary);
+        if (!colonnes_out.is_open()) {
+            std::cerr << "Erreur: impossible de créer " << fichier_colonnes << "\n";
+            liberer_fichier(carte);
+            fermer_flux(lecteur);
+            return 1;
+        }
+        colonnes.dest = &colonnes_out;
+        ecrire_entete_colonnes(colonnes, format.nb_axes);
+        etat.colonnes = &colonnes;
+    }
+    
+    std::unique_ptr<FenetresGlissantes> fenetres;
+    if (fenetres_actives) {
+        fenetres.reset(new FenetresGlissantes);
+        fenetres->trames_par_seconde = static_cast<size_t>(frequence + 0.5f);
+        fenetres->nb_axes = format.nb_axes;
+        etat.fenetres = fenetres.get();
+    }
+    
+    std::unique_ptr<DetecteurSurintensite> surintensites;
+    if (evenements_actifs) {
+        surintensites.reset(new DetecteurSurintensite);
+        initialiser_detecteur(*surintensites, duree_min, format.nb_axes);
+        etat.surintensites = surintensites.get();
+        etat.mode = RAPPORT_RESUME;     // Les événements remplacent les trames
+    }
     
     // ========================================================================
     // Traitement des trames
     // ========================================================================
     
-    Statistiques stats;
-    stats.octets_lus = buffer.size();
-    
     *sortie << "Analyse de télémétrie - Seuil d'alerte: " << seuil_courant << " A\n";
     *sortie << "========================================\n\n";
     
-    // TODO: Implémenter la boucle principale de traitement
-    //
-    // INDICES:
-    // - Parcourir le buffer pour trouver les trames (avec trouver_sync)
-    // - Passer les trames trouvées à decoder_trame et trame_valide
-    // - Analyser les trames valides avec analyser_trame
-    // - Écrire le rapport de chaque trame avec ecrire_rapport_trame
-    // - Mettre à jour les statistiques
+    if (nb_fils > 1 && !mappe) {
+        std::cerr << "Note: -j ignoré, l'entrée n'est pas un fichier régulier\n";
+    } else if (nb_fils > 1 && recherche) {
+        std::cerr << "Note: -j ignoré, seules les zones retenues par l'index sont lues\n";
+        nb_fils = 1;
+    } else if (nb_fils > 1 && conteneur) {
+        std::cerr << "Note: -j ignoré, les blocs d'un conteneur sont décodés dans l'ordre\n";
+        nb_fils = 1;
+    } else if (nb_fils > 1 && (fenetres_actives || evenements_actifs)) {
+        std::cerr << "Note: -j ignoré, --windows et --events suivent le flux dans l'ordre\n";
+        nb_fils = 1;
+    }
     
-
-
+    if (recherche) {
+        IndexRecherche index;
+        bool ok = charger_index(fichier_entree, carte, format, index);
+        if (ok) {
+            analyser_selection(carte, index, sequence_de, sequence_a, alertes_seules, etat);
+        }
+        liberer_fichier(carte);
+        if (!ok) {
+            return 1;
+        }
+    } else if (conteneur) {
+        RegimeAllocations regime;
+        bool ok = analyser_conteneur(carte, etat);
+        liberer_fichier(carte);
+        if (!ok) {
+            return 1;
+        }
+    } else if (mappe && nb_fils > 1) {
+        stats.octets_lus = 0;  // Recompté par segment
+        analyser_en_parallele(carte, nb_fils, etat);
+        liberer_fichier(carte);
+    } else if (mappe) {
+        // Parcours en place, par fenêtres ; une trame à cheval sur deux
+        // fenêtres est reprise au début de la suivante.
+        RegimeAllocations regime;
+        size_t pos = 0;
+        while (pos < carte.taille) {
+            size_t fenetre = std::min(TAILLE_FENETRE_CARTE, carte.taille - pos);
+            bool derniere = pos + fenetre == carte.taille;
+            pos += traiter_tampon(carte.donnees + pos, fenetre, derniere, etat);
+        }
+        liberer_fichier(carte);
+    } else if (pipeline) {
+        analyser_en_pipeline(lecteur, encore, etat, *sortie, coeurs, metriques_pipeline);
+        fermer_flux(lecteur);
+    } else {
+        // Chaque bloc est traité dès sa lecture ; le rapport est vidé après
+        // chaque bloc pour borner la latence en mode pipe.
+        RegimeAllocations regime;
+        for (;;) {
+            size_t consommes = traiter_tampon(lecteur.tampon.data(), lecteur.taille,
+                                              !encore, etat);
+            consommer_bloc(lecteur, consommes);
+            vider_sortie(etat.texte);
+            sortie->flush();
+            
+            if (!encore) {
+                break;
+            }
+            encore = lire_bloc(lecteur, stats);
+        }
+        fermer_flux(lecteur);
+    }
     
     // ========================================================================
     // Affichage des statistiques
     // ========================================================================
     
+    if (etat.surintensites != nullptr) {
+        terminer_surintensites(*etat.surintensites, etat.texte);
+    }
+    vider_sortie(etat.texte);
+    if (etat.colonnes != nullptr) {
+        terminer_colonnes(colonnes, stats);
+    }
     ecrire_statistiques(*sortie, stats);
+    verifier_allocations();
     
     return 0;
 }
@@ -0,0 +1,189 @@
+/**
+ * @file protocole_telemetrie.h
+ * @brief Disposition des trames de télémétrie, commune au simulateur et à l'analyseur
+ *
+ * Une trame est un en-tête de 3 octets (0xAA, 0x55, numéro de séquence)
+ * suivi de 6 octets par axe (position, vitesse, courant, 16 bits
+ * little-endian chacun). Seul le nombre d'axes change d'un modèle de bras à
+ * l'autre : 6 pour le bras industriel (39 octets), 7 pour le cobot
+ * (45 octets). En format v2 (--crc), un CRC-32C de 4 octets suit la trame.
+ *
+ * DispositionTrame<Axes> donne la disposition d'un modèle sous forme de
+ * constantes de compilation : le code qui en dépend est instancié une fois
+ * par modèle, boucles sur les axes déroulées.
+ *
+ * Le CRC-32C du format v2 (polynôme, tables, calcul portable) est défini ici
+ * une seule fois : le simulateur qui l'écrit et l'analyseur qui le vérifie ne
+ * peuvent pas diverger.
+ *
+ * Les adresses réseau "udp:[hôte:]port" et "tcp:[hôte:]port" (sortie du
+ * simulateur, entrée de l'analyseur) se découpent avec decouper_adresse().
+ *
+ * @author GRO221 - Université de Sherbrooke
+ * @date 2025
+ */
+
+#ifndef PROTOCOLE_TELEMETRIE_H
+#define PROTOCOLE_TELEMETRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const uint8_t SYNC_H = 0xAA;
+const uint8_t SYNC_L = 0x55;
+const size_t TAILLE_ENTETE = 3;     // sync1 + sync2 + sequence
+const size_t TAILLE_AXE = 6;        // 2 + 2 + 2 octets
+const size_t TAILLE_CRC = 4;        // Format v2 : CRC-32C après la trame
+
+// Modèles de bras pris en charge (--axes)
+const size_t NB_AXES_BRAS = 6;      // Bras industriel, modèle par défaut
+const size_t NB_AXES_COBOT = 7;     // Cobot
+const size_t MAX_AXES = NB_AXES_COBOT;
+
+/**
+ * @brief Taille d'une trame (sans CRC) pour un nombre d'axes donné
+ */
+constexpr size_t taille_trame_axes(size_t nb_axes) {
+    return TAILLE_ENTETE + nb_axes * TAILLE_AXE;
+}
+
+/**
+ * @brief Vrai si le nombre d'axes correspond à un modèle pris en charge
+ */
+constexpr bool nb_axes_pris_en_charge(size_t nb_axes) {
+    return nb_axes == NB_AXES_BRAS || nb_axes == NB_AXES_COBOT;
+}
+
+/**
+ * @brief Disposition d'une trame à Axes axes, connue à la compilation
+ */
+template <size_t Axes>
+struct DispositionTrame {
+    static_assert(Axes >= 1 && Axes <= MAX_AXES, "nombre d'axes non pris en charge");
+
+    static constexpr size_t nb_axes = Axes;
+    static constexpr size_t taille = taille_trame_axes(Axes);
+
+    // Décalages, depuis le premier octet de sync
+    static constexpr size_t sequence = 2;
+    static constexpr size_t axe(size_t i) { return TAILLE_ENTETE + i * TAILLE_AXE; }
+    static constexpr size_t position(size_t i) { return axe(i); }
+    static constexpr size_t vitesse(size_t i) { return axe(i) + 2; }
+    static constexpr size_t courant(size_t i) { return axe(i) + 4; }
+};
+
+static_assert(DispositionTrame<NB_AXES_BRAS>::taille == 39, "trame du bras : 39 octets");
+static_assert(DispositionTrame<NB_AXES_COBOT>::taille == 45, "trame du cobot : 45 octets");
+
+// ============================================================================
+// CRC-32C du format v2 (--crc)
+// ============================================================================
+//
+// Castagnoli : polynôme réfléchi 0x82F63B78, valeur initiale et xor final
+// 0xFFFFFFFF, calculé sur les octets de la trame et écrit en little-endian
+// juste après elle.
+
+const uint32_t POLYNOME_CRC32C = 0x82F63B78u;
+
+struct TablesCrc {
+    uint32_t t[8][256];
+};
+
+/**
+ * @brief Construit les tables slicing-by-8 du CRC-32C
+ *
+ * t[0] est la table classique octet par octet ; t[k][i] est le CRC de
+ * l'octet i suivi de k octets nuls.
+ */
+constexpr TablesCrc construire_tables_crc() {
+    TablesCrc tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? POLYNOME_CRC32C : 0u);
+        }
+        tables.t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (size_t k = 1; k < 8; k++) {
+            uint32_t precedent = tables.t[k - 1][i];
+            tables.t[k][i] = (precedent >> 8) ^ tables.t[0][precedent & 0xFF];
+        }
+    }
+    return tables;
+}
+
+// Construites à la compilation
+inline constexpr TablesCrc TABLES_CRC32C = construire_tables_crc();
+
+static_assert(TABLES_CRC32C.t[0][1] == 0xF26B8303u, "table du CRC-32C");
+
+/**
+ * @brief CRC-32C par tables, 8 octets par itération
+ */
+inline uint32_t crc32c_tables(const uint8_t* donnees, size_t taille) {
+    const auto& t = TABLES_CRC32C.t;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (taille >= 8) {
+        uint32_t bas = crc ^ (static_cast<uint32_t>(donnees[0]) |
+                              static_cast<uint32_t>(donnees[1]) << 8 |
+                              static_cast<uint32_t>(donnees[2]) << 16 |
+                              static_cast<uint32_t>(donnees[3]) << 24);
+        crc = t[7][bas & 0xFF] ^ t[6][(bas >> 8) & 0xFF] ^
+              t[5][(bas >> 16) & 0xFF] ^ t[4][bas >> 24] ^
+              t[3][donnees[4]] ^ t[2][donnees[5]] ^ t[1][donnees[6]] ^ t[0][donnees[7]];
+        donnees += 8;
+        taille -= 8;
+    }
+    while (taille-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *donnees++) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// ============================================================================
+// Adresses réseau
+// ============================================================================
+
+/**
+ * @brief Adresse "udp:[hôte:]port" ou "tcp:[hôte:]port" découpée
+ */
+struct AdresseReseau {
+    bool udp = false;
+    std::string hote;               // Vide si absent ; sans crochets pour IPv6
+    std::string port;
+};
+
+/**
+ * @brief Vrai si le nom désigne une adresse réseau (udp:… ou tcp:…)
+ */
+inline bool est_adresse_reseau(const std::string& nom) {
+    return nom.compare(0, 4, "udp:") == 0 || nom.compare(0, 4, "tcp:") == 0;
+}
+
+/**
+ * @brief Découpe une adresse réseau (voir est_adresse_reseau())
+ *
+ * Le port suit le dernier ':' ; un hôte IPv6 s'écrit entre crochets
+ * ("udp:[::1]:9000"). La validité est laissée à getaddrinfo().
+ */
+inline AdresseReseau decouper_adresse(const std::string& nom) {
+    AdresseReseau adresse;
+    adresse.udp = nom.compare(0, 4, "udp:") == 0;
+    std::string reste = nom.substr(4);
+    adresse.port = reste;
+    size_t deux_points = reste.rfind(':');
+    if (deux_points != std::string::npos) {
+        adresse.hote = reste.substr(0, deux_points);
+        adresse.port = reste.substr(deux_points + 1);
+        const std::string& hote = adresse.hote;
+        if (hote.size() >= 2 && hote.front() == '[' && hote.back() == ']') {
+            adresse.hote = hote.substr(1, hote.size() - 2);
+        }
+    }
+    return adresse;
+}
+
+#endif // PROTOCOLE_TELEMETRIE_H
@@ -1,6 +1,6 @@
 /**
  * @file simulateur_telemetrie.cpp
- * @brief Simulateur de données de télémétrie pour bras robotisé 6 axes
+ * @brief Simulateur de données de télémétrie pour bras robotisé 6 axes (ou cobot 7 axes)
  * 
  * Ce programme génère des trames de télémétrie réalistes sur la sortie standard,
  * simulant un contrôleur de bras robotisé. Il peut être utilisé avec un pipe
@@ -17,6 +17,19 @@
  *     -f <freq>     Fréquence en Hz (défaut: 100)
  *     -b <prob>     Probabilité de bruit entre trames (0.0-1.0, défaut: 0.05)
  *     -a <prob>     Probabilité d'alerte courant (0.0-1.0, défaut: 0.02)
+ *     -r            Mode temps réel (attente entre trames)
+ *     --fast        Écrit par blocs d'environ 1 Mo (génération de grosses captures)
+ *     --seed <n>    Graine du générateur (défaut: aléatoire)
+ *     --crc         Trames au format v2 : suivies d'un CRC-32C (43 octets)
+ *     --axes <n>    Modèle de bras : 6 axes (défaut, 39 octets) ou 7 (cobot, 45 octets)
+ *     --compress    Écrit un conteneur compressé (TLMZ) au lieu des trames brutes
+ *     --rng <nom>   Générateur : xoshiro (défaut) ou mt19937
+ *     --robots <k>  Simule k bras en parallèle (un fil et un flux aléatoire chacun)
+ *     --output <m>  Un fichier par robot, "%d" remplacé par son numéro, ou une
+ *                   destination réseau udp:hôte:port / tcp:hôte:port
+ *     --burst <n>   Trames envoyées ensemble, une échéance par rafale en -r
+ *     --replay <f>  Réémet une capture .bin existante au lieu de générer
+ *     --speed <x>   Avec --replay -r : rythme de -f multiplié par x
  *     -h            Affiche l'aide
  * 
  * @author GRO221 - Université de Sherbrooke
@@ -31,21 +44,160 @@
 #include <chrono>
 #include <thread>
 #include <random>
+#include <vector>
+#include <cerrno>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "protocole_telemetrie.h"
 
 // ============================================================================
 // Constantes du protocole
 // ============================================================================
 
-const uint8_t SYNC_H = 0xAA;
-const uint8_t SYNC_L = 0x55;
-const size_t NB_AXES = 6;
-const size_t TAILLE_TRAME = 39;  // 2 sync + 1 seq + 6*6 données
+// Sync, disposition des trames et modèles de bras : protocole_telemetrie.h
+const int MAX_OCTETS_BRUIT = 10;  // Bruit injecté avant une trame, au plus
+
+// Mode --fast : taille visée d'un write(2)
+const size_t TAILLE_BLOC_ECRITURE = 1024 * 1024;
+
+// Flux entrelacé (--robots sans --output) : chaque bloc est précédé de
+// 'R' 'B', u16 numéro de robot, u32 longueur du bloc (little-endian)
+const size_t TAILLE_ENTETE_ROBOT = 8;
+const size_t MAX_ROBOTS = 65535;
+
+// Sortie UDP : charge utile d'un datagramme, sans fragmentation sur Ethernet
+// (trames entières seulement), et datagrammes par appel à sendmmsg()
+const size_t TAILLE_MAX_DATAGRAMME = 1472;
+const size_t NB_MAX_DATAGRAMMES = 256;
+const int TAILLE_TAMPON_SOCKET = 8 * 1024 * 1024;
+
+// Fin d'un flux UDP : datagramme vide répété, espacé, pour survivre à une perte
+// (l'analyseur ne retient que le premier, et finit sinon après --idle)
+const int NB_MARQUES_FIN = 3;
+const auto ECART_MARQUES_FIN = std::chrono::milliseconds(1);
+
+// Mode temps réel : l'attente d'une échéance se termine en attente active
+// sur cette durée, pour ne pas dépendre du dépassement de sleep_until()
+const auto MARGE_ATTENTE_ACTIVE = std::chrono::microseconds(100);
+const size_t MAX_RAFALE = 65536;
+
+// Limites physiques réalistes pour un bras robotisé industriel ; le 7e axe
+// (poignet redondant) n'existe que sur le cobot
+const float POSITION_MIN_DEG[MAX_AXES] = {-170.0f, -90.0f, -80.0f, -190.0f, -120.0f, -360.0f, -175.0f};
+const float POSITION_MAX_DEG[MAX_AXES] = { 170.0f, 110.0f, 280.0f,  190.0f,  120.0f,  360.0f,  175.0f};
+const float VITESSE_MAX_DEG_S[MAX_AXES] = {250.0f, 250.0f, 250.0f, 430.0f, 430.0f, 630.0f, 180.0f};
+const float COURANT_NOMINAL_A[MAX_AXES] = {8.0f, 6.0f, 4.0f, 2.0f, 2.0f, 1.5f, 1.0f};
+
+// ============================================================================
+// Générateur pseudo-aléatoire
+// ============================================================================
+
+enum TypeGenerateur {
+    GENERATEUR_XOSHIRO,     // xoshiro256** (défaut)
+    GENERATEUR_MT19937      // std::mt19937_64
+};
+
+/**
+ * @brief Source de bits aléatoires 64 bits (UniformRandomBitGenerator)
+ *
+ * xoshiro256** ne coûte que quelques décalages et multiplications par tirage
+ * pour un état de 32 octets ; std::mt19937_64 reste disponible (--rng).
+ * À graine égale, le flux (et donc la capture) est identique d'une exécution
+ * à l'autre.
+ */
+struct Aleatoire {
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    TypeGenerateur type = GENERATEUR_XOSHIRO;
+    uint64_t etat[4] = {1, 2, 3, 4};
+    std::mt19937_64 mt;
+
+    result_type operator()() {
+        if (type == GENERATEUR_MT19937) {
+            return mt();
+        }
+        uint64_t resultat = rotation(etat[1] * 5, 7) * 9;
+        uint64_t t = etat[1] << 17;
+        etat[2] ^= etat[0];
+        etat[3] ^= etat[1];
+        etat[1] ^= etat[2];
+        etat[0] ^= etat[3];
+        etat[2] ^= t;
+        etat[3] = rotation(etat[3], 45);
+        return resultat;
+    }
+
+    static uint64_t rotation(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+/**
+ * @brief Initialise le générateur à partir d'une graine 64 bits
+ *
+ * L'état de xoshiro est dérivé de la graine par splitmix64, comme le
+ * recommandent ses auteurs (un état nul est impossible).
+ */
+void initialiser_aleatoire(Aleatoire& rng, TypeGenerateur type, uint64_t graine) {
+    rng.type = type;
+    rng.mt.seed(graine);
+    uint64_t x = graine;
+    for (uint64_t& mot : rng.etat) {
+        x += 0x9E3779B97F4A7C15ull;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        mot = z ^ (z >> 31);
+    }
+}
+
+/**
+ * @brief Tirages de loi normale centrée réduite, produits par lots
+ *
+ * Box–Muller donne deux valeurs indépendantes par paire d'uniformes : le
+ * lot est rempli d'un coup (boucle sans dépendance entre paires), puis
+ * consommé valeur par valeur.
+ */
+const size_t TAILLE_LOT_NORMALES = 64;
+
+struct EchantillonneurNormal {
+    float valeurs[TAILLE_LOT_NORMALES];
+    size_t restantes = 0;
+};
 
-// Limites physiques réalistes pour un bras robotisé industriel
-const float POSITION_MIN_DEG[NB_AXES] = {-170.0f, -90.0f, -80.0f, -190.0f, -120.0f, -360.0f};
-const float POSITION_MAX_DEG[NB_AXES] = { 170.0f, 110.0f, 280.0f,  190.0f,  120.0f,  360.0f};
-const float VITESSE_MAX_DEG_S[NB_AXES] = {250.0f, 250.0f, 250.0f, 430.0f, 430.0f, 630.0f};
-const float COURANT_NOMINAL_A[NB_AXES] = {8.0f, 6.0f, 4.0f, 2.0f, 2.0f, 1.5f};
+float tirer_normale(EchantillonneurNormal& lot, Aleatoire& rng) {
+    if (lot.restantes == 0) {
+        const float deux_pi = 6.28318530718f;
+        for (size_t k = 0; k < TAILLE_LOT_NORMALES; k += 2) {
+            // u1 dans ]0, 1] (log fini), u2 dans [0, 1[ ; 24 bits chacun
+            float u1 = static_cast<float>((rng() >> 40) + 1) * 0x1p-24f;
+            float u2 = static_cast<float>(rng() >> 40) * 0x1p-24f;
+            float r = std::sqrt(-2.0f * std::log(u1));
+            lot.valeurs[k] = r * std::cos(deux_pi * u2);
+            lot.valeurs[k + 1] = r * std::sin(deux_pi * u2);
+        }
+        lot.restantes = TAILLE_LOT_NORMALES;
+    }
+    return lot.valeurs[--lot.restantes];
+}
 
 // ============================================================================
 // État du simulateur
@@ -65,26 +217,42 @@ struct EtatAxe {
 };
 
 struct Simulateur {
-    EtatAxe axes[NB_AXES];
+    size_t nb_axes;          // Modèle de bras (--axes)
+    EtatAxe axes[MAX_AXES];
     uint8_t sequence;
-    std::mt19937 rng;
+    Aleatoire rng;
+    
+    // Distributions construites une fois pour toutes
+    std::uniform_real_distribution<float> uniforme{0.0f, 1.0f};
+    std::uniform_real_distribution<float> dist_cible[MAX_AXES];
+    std::uniform_int_distribution<int> dist_axe;
+    std::uniform_real_distribution<float> dist_courant_alerte{5500.0f, 8000.0f};  // mA
+    std::uniform_int_distribution<int> dist_nb_bruit{1, MAX_OCTETS_BRUIT};
+    EchantillonneurNormal normale;
     
     // Paramètres de simulation
     float dt;                // Pas de temps (1/freq)
     float prob_bruit;        // Probabilité d'injecter du bruit
     float prob_alerte;       // Probabilité d'alerte courant
     
-    Simulateur(float freq, float bruit, float alerte) 
-        : sequence(0), prob_bruit(bruit), prob_alerte(alerte) {
+    Simulateur(size_t axes_bras, float freq, float bruit, float alerte, TypeGenerateur generateur,
+               uint64_t graine)
+        : nb_axes(axes_bras), sequence(0), dist_axe(0, static_cast<int>(axes_bras) - 1),
+          prob_bruit(bruit), prob_alerte(alerte) {
         
         dt = 1.0f / freq;
         
         // Initialiser le générateur aléatoire
-        std::random_device rd;
-        rng.seed(rd());
+        initialiser_aleatoire(rng, generateur, graine);
+        
+        // Cibles de mouvement : 80 % de la course de chaque axe
+        for (size_t i = 0; i < nb_axes; i++) {
+            dist_cible[i] = std::uniform_real_distribution<float>(
+                POSITION_MIN_DEG[i] * 0.8f, POSITION_MAX_DEG[i] * 0.8f);
+        }
         
         // Initialiser les axes à des positions de repos
-        for (size_t i = 0; i < NB_AXES; i++) {
+        for (size_t i = 0; i < nb_axes; i++) {
             axes[i].position_deg = 0.0f;
             axes[i].vitesse_deg_s = 0.0f;
             axes[i].position_cible = 0.0f;
@@ -101,11 +269,7 @@ struct Simulateur {
  * @brief Met à jour la cible de position d'un axe (nouveau mouvement aléatoire)
  */
 void nouvelle_cible(Simulateur& sim, size_t axe) {
-    std::uniform_real_distribution<float> dist(
-        POSITION_MIN_DEG[axe] * 0.8f, 
-        POSITION_MAX_DEG[axe] * 0.8f
-    );
-    sim.axes[axe].position_cible = dist(sim.rng);
+    sim.axes[axe].position_cible = sim.dist_cible[axe](sim.rng);
 }
 
 /**
@@ -119,8 +283,7 @@ void simuler_axe(Simulateur& sim, size_t axe) {
     
     // Si proche de la cible, nouvelle cible (probabilité)
     if (std::abs(erreur) < 1.0f) {
-        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-        if (dist(sim.rng) < 0.02f) {  // 2% de chance par frame
+        if (sim.uniforme(sim.rng) < 0.02f) {  // 2% de chance par frame
             nouvelle_cible(sim, axe);
             erreur = a.position_cible - a.position_deg;
         }
@@ -160,9 +323,8 @@ void simuler_axe(Simulateur& sim, size_t axe) {
     float ratio_vitesse = std::abs(a.vitesse_deg_s) / VITESSE_MAX_DEG_S[axe];
     a.courant_base_a = COURANT_NOMINAL_A[axe] * (0.1f + 0.9f * ratio_vitesse);
     
-    // Bruit sur le courant
-    std::normal_distribution<float> bruit(0.0f, a.courant_base_a * 0.05f);
-    a.courant_base_a += bruit(sim.rng);
+    // Bruit sur le courant (écart-type : 5 % du courant)
+    a.courant_base_a += a.courant_base_a * 0.05f * tirer_normale(sim.normale, sim.rng);
     if (a.courant_base_a < 0.0f) a.courant_base_a = 0.0f;
 }
 
@@ -192,9 +354,10 @@ void ecrire_uint16_le(uint8_t* buffer, uint16_t valeur) {
  *   [21-26]  : Axe 4
  *   [27-32]  : Axe 5
  *   [33-38]  : Axe 6
+ *   [39-44]  : Axe 7 (cobot seulement, trame de 45 octets)
  *
  * @param sim État du simulateur
- * @param buffer Buffer de 39 octets où écrire la trame
+ * @param buffer Buffer de taille_trame_axes(sim.nb_axes) octets où écrire la trame
  */
 void generer_trame(Simulateur& sim, uint8_t* buffer) {
     // En-tête de la trame
@@ -202,23 +365,19 @@ void generer_trame(Simulateur& sim, uint8_t* buffer) {
     buffer[1] = SYNC_L;
     buffer[2] = sim.sequence++;
 
-    std::uniform_real_distribution<float> dist_alerte(0.0f, 1.0f);
-    std::uniform_int_distribution<int> dist_axe(0, NB_AXES - 1);
-
     // Déterminer s'il y a une alerte et sur quel axe
     int axe_alerte = -1;
     uint16_t courant_alerte = 0;
-    if (dist_alerte(sim.rng) < sim.prob_alerte) {
-        axe_alerte = dist_axe(sim.rng);
+    if (sim.uniforme(sim.rng) < sim.prob_alerte) {
+        axe_alerte = sim.dist_axe(sim.rng);
         // Courant élevé : 5.5 à 8.0 A (en milliampères)
-        std::uniform_real_distribution<float> dist_courant(5500.0f, 8000.0f);
-        courant_alerte = static_cast<uint16_t>(dist_courant(sim.rng));
+        courant_alerte = static_cast<uint16_t>(sim.dist_courant_alerte(sim.rng));
     }
 
     // Générer les données de chaque axe
     uint8_t* ptr = buffer + 3;  // Pointeur vers les données des axes
 
-    for (size_t i = 0; i < NB_AXES; i++) {
+    for (size_t i = 0; i < sim.nb_axes; i++) {
         simuler_axe(sim, i);
 
         // Conversion vers les unités brutes (entiers)
@@ -246,20 +405,865 @@ void generer_trame(Simulateur& sim, uint8_t* buffer) {
     }
 }
 
+/**
+ * @brief Ajoute le CRC-32C d'une trame à sa suite (format v2, --crc)
+ *
+ * Voir crc32c_tables() (protocole_telemetrie.h), commun avec l'analyseur ;
+ * octets [39-42] pour le bras à 6 axes.
+ *
+ * @param buffer Trame de @p taille octets suivie de 4 octets libres
+ * @param taille Taille de la trame (sans le CRC)
+ */
+void ajouter_crc(uint8_t* buffer, size_t taille) {
+    uint32_t crc = crc32c_tables(buffer, taille);
+    ecrire_uint16_le(buffer + taille, static_cast<uint16_t>(crc & 0xFFFF));
+    ecrire_uint16_le(buffer + taille + 2, static_cast<uint16_t>(crc >> 16));
+}
+
 /**
  * @brief Génère des octets de bruit aléatoires (simule désynchronisation)
+ * @param sim État du simulateur
+ * @param buffer Buffer d'au moins nb_octets octets où écrire le bruit
+ * @param nb_octets Nombre d'octets de bruit
  */
-void generer_bruit(Simulateur& sim, int nb_octets) {
-    std::uniform_int_distribution<int> dist(0, 255);
+void generer_bruit(Simulateur& sim, uint8_t* buffer, int nb_octets) {
+    uint64_t bits = 0;
     
     for (int i = 0; i < nb_octets; i++) {
-        uint8_t octet = static_cast<uint8_t>(dist(sim.rng));
+        // Un tirage 64 bits fournit 8 octets
+        if (i % 8 == 0) {
+            bits = sim.rng();
+        }
+        uint8_t octet = static_cast<uint8_t>(bits >> (8 * (i % 8)));
         // Éviter de générer accidentellement les octets de sync
         if (octet == SYNC_H || octet == SYNC_L) {
             octet = 0x00;
         }
-        std::cout.write(reinterpret_cast<char*>(&octet), 1);
+        buffer[i] = octet;
+    }
+}
+
+/**
+ * @brief Écrit tout le buffer sur un descripteur (write(2) repris si partiel)
+ * @return false sur erreur d'écriture (lecteur fermé, disque plein...)
+ */
+bool ecrire_tout(int fd, const uint8_t* buffer, size_t taille) {
+    while (taille > 0) {
+        ssize_t n = write(fd, buffer, taille);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Erreur d'écriture : " << std::strerror(errno) << "\n";
+            return false;
+        }
+        buffer += n;
+        taille -= static_cast<size_t>(n);
     }
+    return true;
+}
+
+// ============================================================================
+// Sortie réseau (--output udp:… / tcp:…)
+// ============================================================================
+
+/**
+ * @brief Ouvre une socket connectée vers "udp:[hôte:]port" ou "tcp:[hôte:]port"
+ *
+ * Sans hôte, la destination est 127.0.0.1. Le tampon d'émission est
+ * agrandi pour absorber les rafales ; en TCP, Nagle est désactivé pour que
+ * chaque envoi parte aussitôt.
+ *
+ * @return Descripteur, ou -1 (message sur stderr)
+ */
+int ouvrir_socket(const std::string& destination) {
+    const AdresseReseau adresse = decouper_adresse(destination);
+    const bool udp = adresse.udp;
+
+    addrinfo indications = {};
+    indications.ai_family = AF_UNSPEC;
+    indications.ai_socktype = udp ? SOCK_DGRAM : SOCK_STREAM;
+    addrinfo* resultats = nullptr;
+    int code = getaddrinfo(adresse.hote.empty() ? "127.0.0.1" : adresse.hote.c_str(),
+                           adresse.port.c_str(), &indications, &resultats);
+    if (code != 0) {
+        std::cerr << "Erreur: destination " << destination << " invalide ("
+                  << gai_strerror(code) << ")\n";
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* r = resultats; r != nullptr && fd < 0; r = r->ai_next) {
+        fd = socket(r->ai_family, r->ai_socktype | SOCK_CLOEXEC, r->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int taille = TAILLE_TAMPON_SOCKET;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &taille, sizeof(taille));
+        if (!udp) {
+            int oui = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &oui, sizeof(oui));
+        }
+        if (connect(fd, r->ai_addr, r->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(resultats);
+    if (fd < 0) {
+        std::cerr << "Erreur: impossible de joindre " << destination << " ("
+                  << std::strerror(errno) << ")\n";
+    }
+    return fd;
+}
+
+/**
+ * @brief Envoie des datagrammes consécutifs d'un même buffer (sendmmsg)
+ *
+ * @param donnees Début du premier datagramme
+ * @param bornes Début de chaque datagramme dans @p donnees (bornes[0] == 0)
+ * @param taille Fin du dernier datagramme
+ * @return false sur erreur d'envoi
+ */
+bool envoyer_datagrammes(int fd, const uint8_t* donnees, const std::vector<size_t>& bornes,
+                         size_t taille) {
+    mmsghdr messages[NB_MAX_DATAGRAMMES];
+    iovec cases[NB_MAX_DATAGRAMMES];
+    size_t k = 0;
+    while (k < bornes.size()) {
+        size_t nb = std::min(NB_MAX_DATAGRAMMES, bornes.size() - k);
+        for (size_t d = 0; d < nb; d++) {
+            size_t debut = bornes[k + d];
+            size_t fin = k + d + 1 < bornes.size() ? bornes[k + d + 1] : taille;
+            cases[d].iov_base = const_cast<uint8_t*>(donnees + debut);
+            cases[d].iov_len = fin - debut;
+            messages[d] = mmsghdr();
+            messages[d].msg_hdr.msg_iov = &cases[d];
+            messages[d].msg_hdr.msg_iovlen = 1;
+        }
+        int n = sendmmsg(fd, messages, static_cast<unsigned>(nb), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == ECONNREFUSED) {
+            // Personne n'écoute (encore) : le datagramme est perdu, comme en vrai
+            static std::atomic<bool> averti{false};
+            if (!averti.exchange(true)) {
+                std::cerr << "Note: aucun récepteur, des datagrammes sont perdus\n";
+            }
+            n = 1;
+        } else if (n < 0) {
+            std::cerr << "Erreur d'envoi : " << std::strerror(errno) << "\n";
+            return false;
+        }
+        k += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// ============================================================================
+// Cadence du mode temps réel (-r)
+// ============================================================================
+//
+// Chaque rafale (--burst trames, une par défaut) a une échéance absolue :
+// debut + k * periode. Une attente trop longue ou une rafale lente ne
+// décalent donc pas les suivantes, et la fréquence moyenne est exactement
+// celle demandée (sleep_for() après chaque trame accumulait ses
+// dépassements). L'attente dort jusqu'à MARGE_ATTENTE_ACTIVE avant
+// l'échéance puis termine en attente active. Le retard de chaque envoi sur
+// son échéance mesure la gigue.
+
+struct Cadence {
+    std::chrono::steady_clock::time_point debut;
+    std::chrono::steady_clock::time_point dernier_envoi;
+    double periode_ns = 0.0;    // Entre deux échéances (une rafale)
+    uint64_t echeances = 0;     // Échéances atteintes
+    double somme_retard_ns = 0.0;
+    double somme_carres_ns = 0.0;
+    double retard_max_ns = 0.0;
+};
+
+/**
+ * @brief Fixe la première échéance à maintenant
+ */
+void demarrer_cadence(Cadence& cadence, float frequence, size_t rafale) {
+    cadence.debut = std::chrono::steady_clock::now();
+    cadence.periode_ns = 1e9 * static_cast<double>(rafale) / frequence;
+}
+
+/**
+ * @brief Attend l'échéance de la prochaine rafale et note le retard
+ */
+void attendre_echeance(Cadence& cadence) {
+    using namespace std::chrono;
+    auto echeance = cadence.debut + nanoseconds(static_cast<int64_t>(
+        std::llround(static_cast<double>(cadence.echeances) * cadence.periode_ns)));
+    if (steady_clock::now() < echeance - MARGE_ATTENTE_ACTIVE) {
+        std::this_thread::sleep_until(echeance - MARGE_ATTENTE_ACTIVE);
+    }
+    auto maintenant = steady_clock::now();
+    while (maintenant < echeance) {
+        maintenant = steady_clock::now();
+    }
+
+    double retard = static_cast<double>(duration_cast<nanoseconds>(maintenant - echeance).count());
+    cadence.somme_retard_ns += retard;
+    cadence.somme_carres_ns += retard * retard;
+    cadence.retard_max_ns = std::max(cadence.retard_max_ns, retard);
+    cadence.dernier_envoi = maintenant;
+    cadence.echeances++;
+}
+
+/**
+ * @brief Fréquence obtenue et gigue, sur une ligne
+ *
+ * La fréquence est mesurée de la première à la dernière échéance.
+ */
+std::string bilan_cadence(const Cadence& cadence, float frequence, size_t rafale) {
+    std::ostringstream ligne;
+    ligne << std::fixed << std::setprecision(1);
+    const double n = static_cast<double>(cadence.echeances);
+    if (cadence.echeances < 2) {
+        ligne << "trop peu d'envois pour mesurer la cadence";
+        return ligne.str();
+    }
+    double duree_s = std::chrono::duration<double>(cadence.dernier_envoi - cadence.debut).count();
+    double obtenue = (n - 1.0) * static_cast<double>(rafale) / duree_s;
+    double moyenne = cadence.somme_retard_ns / n;
+    double ecart = std::sqrt(std::max(0.0, cadence.somme_carres_ns / n - moyenne * moyenne));
+    ligne << obtenue << " trames/s obtenues (visé " << frequence << ") en " << std::setprecision(3)
+          << duree_s << " s ; retard sur échéance moy " << std::setprecision(1) << moyenne / 1e3
+          << " µs, écart-type " << ecart / 1e3 << " µs, max " << cadence.retard_max_ns / 1e3
+          << " µs";
+    return ligne.str();
+}
+
+// ============================================================================
+// Conteneur compressé (--compress)
+// ============================================================================
+//
+// Pour l'archivage, les trames (sans le bruit ni le CRC) sont regroupées en
+// blocs de TRAMES_PAR_BLOC et chaque champ est écrit en colonne, sous forme
+// d'écarts d'une trame à l'autre (ordre 1) ou d'écarts d'écarts (ordre 2,
+// adapté aux positions : l'accélération est bornée). Les résidus, ramenés
+// en entiers positifs (zigzag), sont tassés sur une largeur fixe de bits
+// par colonne et par bloc ; les rares résidus plus larges (pics de courant,
+// retour de la séquence à 0) sont écrits à part, en exceptions. Tous les
+// entiers sont en little-endian.
+//
+//   En-tête : "TLMZ", u16 version, u16 nb_colonnes, u32 trames_par_bloc, u32 0
+//   Bloc    : "BLKZ", u32 n, u32 taille (octets du bloc après ces 12), puis
+//             par colonne : u8 ordre (1 ou 2), u8 largeur (0 à 16 bits),
+//             u16 nb_exceptions, u16 v0, u16 v1 (deux premières valeurs),
+//             les n - 2 résidus suivants sur `largeur` bits (poids faibles
+//             d'abord), complétés à l'octet, puis nb_exceptions fois
+//             (u16 rang, u16 résidu) ; le bloc est complété par des 0
+//             jusqu'à un multiple de 8 octets, puis 8 octets à 0
+//   Index   : "INDX", u32 nb_blocs, par bloc : u64 position, u64 rang de la
+//             première trame, u32 n, u32 0
+//   Fin     : u64 position de l'index, "TLMZ", u32 0
+//
+// Colonnes (valeurs 16 bits, calculs modulo 2^16) : position_1..N,
+// vitesse_1..N, courant_1..N, séquence, pour N = 6 axes (19 colonnes) ou
+// 7 (cobot, 22 colonnes) ; mêmes unités que la trame.
+
+const uint16_t VERSION_CONTENEUR = 1;
+const size_t MAX_COLONNES_CONTENEUR = 3 * MAX_AXES + 1;
+const size_t TRAMES_PAR_BLOC = 1024;
+const size_t LARGEUR_MAX_RESIDU = 16;
+const size_t TAILLE_EXCEPTION = 4;      // u16 rang, u16 résidu
+
+struct EntreeIndexConteneur {
+    uint64_t position;
+    uint64_t premiere;
+    uint32_t nb;
+};
+
+/**
+ * @brief Conteneur en cours d'écriture
+ *
+ * Les octets à émettre sont construits dans `octets`, après
+ * TAILLE_ENTETE_ROBOT octets réservés (voir emettre()).
+ */
+struct ArchiveCompressee {
+    size_t nb_axes = NB_AXES_BRAS;
+    uint16_t colonnes[MAX_COLONNES_CONTENEUR][TRAMES_PAR_BLOC];
+    size_t nb = 0;                  // Trames du bloc en cours
+    uint64_t position = 0;          // Octets déjà émis
+    uint64_t trames = 0;            // Trames déjà écrites dans des blocs
+    std::vector<EntreeIndexConteneur> index;
+    std::vector<uint8_t> octets;
+};
+
+/**
+ * @brief Ajoute un entier little-endian de @p nb_octets octets
+ */
+void ajouter_le(std::vector<uint8_t>& octets, uint64_t valeur, size_t nb_octets) {
+    for (size_t k = 0; k < nb_octets; k++) {
+        octets.push_back(static_cast<uint8_t>(valeur >> (8 * k)));
+    }
+}
+
+/**
+ * @brief Vide les octets en attente, en ne gardant que la réserve d'en-tête
+ */
+void preparer_octets(ArchiveCompressee& archive) {
+    archive.octets.assign(TAILLE_ENTETE_ROBOT, 0);
+}
+
+/**
+ * @brief Nombre de bits significatifs d'un résidu (0 pour 0)
+ */
+inline size_t largeur_residu(uint16_t residu) {
+    return residu == 0 ? 0 : 32 - static_cast<size_t>(__builtin_clz(residu));
+}
+
+/**
+ * @brief Résidus zigzag d'une colonne, à l'ordre 1 ou 2, pour les rangs 2..n-1
+ */
+void calculer_residus(const uint16_t* v, size_t n, int ordre, uint16_t* residus) {
+    for (size_t k = 2; k < n; k++) {
+        uint16_t prediction = ordre == 1 ? v[k - 1]
+                                         : static_cast<uint16_t>(2 * v[k - 1] - v[k - 2]);
+        int16_t ecart = static_cast<int16_t>(static_cast<uint16_t>(v[k] - prediction));
+        residus[k - 2] = static_cast<uint16_t>((static_cast<uint16_t>(ecart) << 1) ^
+                                               static_cast<uint16_t>(ecart >> 15));
+    }
+}
+
+/**
+ * @brief Choisit la largeur qui minimise la taille des résidus et des exceptions
+ * @param taille Sortie : octets occupés avec cette largeur
+ */
+size_t choisir_largeur(const uint16_t* residus, size_t m, size_t& taille) {
+    size_t histogramme[LARGEUR_MAX_RESIDU + 1] = {};
+    for (size_t k = 0; k < m; k++) {
+        histogramme[largeur_residu(residus[k])]++;
+    }
+    size_t meilleure = LARGEUR_MAX_RESIDU;
+    taille = SIZE_MAX;
+    size_t exceptions = 0;       // Résidus plus larges que w
+    for (size_t w = LARGEUR_MAX_RESIDU + 1; w-- > 0;) {
+        size_t t = (m * w + 7) / 8 + exceptions * TAILLE_EXCEPTION;
+        if (t <= taille) {
+            taille = t;
+            meilleure = w;
+        }
+        exceptions += histogramme[w];
+    }
+    return meilleure;
+}
+
+/**
+ * @brief Encode une colonne du bloc à la suite de @p octets
+ */
+void encoder_colonne(std::vector<uint8_t>& octets, const uint16_t* v, size_t n) {
+    uint16_t residus[2][TRAMES_PAR_BLOC];
+    size_t m = n > 2 ? n - 2 : 0;
+    size_t taille[2];
+    size_t largeur[2];
+    for (int ordre = 1; ordre <= 2; ordre++) {
+        calculer_residus(v, n, ordre, residus[ordre - 1]);
+        largeur[ordre - 1] = choisir_largeur(residus[ordre - 1], m, taille[ordre - 1]);
+    }
+    int ordre = taille[1] < taille[0] ? 2 : 1;
+    const uint16_t* r = residus[ordre - 1];
+    size_t w = largeur[ordre - 1];
+
+    size_t nb_exceptions = 0;
+    for (size_t k = 0; k < m; k++) {
+        nb_exceptions += largeur_residu(r[k]) > w;
+    }
+    octets.push_back(static_cast<uint8_t>(ordre));
+    octets.push_back(static_cast<uint8_t>(w));
+    ajouter_le(octets, nb_exceptions, 2);
+    ajouter_le(octets, v[0], 2);
+    ajouter_le(octets, n > 1 ? v[1] : 0, 2);
+
+    // Résidus tassés, poids faibles d'abord ; une exception laisse un champ à 0
+    uint64_t accumulateur = 0;
+    size_t bits = 0;
+    for (size_t k = 0; k < m; k++) {
+        uint64_t champ = largeur_residu(r[k]) > w ? 0 : r[k];
+        accumulateur |= champ << bits;
+        bits += w;
+        while (bits >= 8) {
+            octets.push_back(static_cast<uint8_t>(accumulateur));
+            accumulateur >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) {
+        octets.push_back(static_cast<uint8_t>(accumulateur));
+    }
+
+    for (size_t k = 0; k < m; k++) {
+        if (largeur_residu(r[k]) > w) {
+            ajouter_le(octets, k + 2, 2);
+            ajouter_le(octets, r[k], 2);
+        }
+    }
+}
+
+/**
+ * @brief Nombre de colonnes du conteneur : trois par axe, plus la séquence
+ */
+inline size_t nb_colonnes_archive(const ArchiveCompressee& archive) {
+    return 3 * archive.nb_axes + 1;
+}
+
+/**
+ * @brief Écrit l'en-tête du conteneur dans les octets en attente
+ */
+void ouvrir_archive(ArchiveCompressee& archive, size_t nb_axes) {
+    archive.nb_axes = nb_axes;
+    preparer_octets(archive);
+    const char magique[4] = {'T', 'L', 'M', 'Z'};
+    archive.octets.insert(archive.octets.end(), magique, magique + 4);
+    ajouter_le(archive.octets, VERSION_CONTENEUR, 2);
+    ajouter_le(archive.octets, nb_colonnes_archive(archive), 2);
+    ajouter_le(archive.octets, TRAMES_PAR_BLOC, 4);
+    ajouter_le(archive.octets, 0, 4);
+}
+
+/**
+ * @brief Encode le bloc en cours à la suite des octets en attente
+ */
+void fermer_bloc(ArchiveCompressee& archive) {
+    if (archive.nb == 0) {
+        return;
+    }
+    std::vector<uint8_t>& o = archive.octets;
+    uint64_t position = archive.position + (o.size() - TAILLE_ENTETE_ROBOT);
+    archive.index.push_back({position, archive.trames, static_cast<uint32_t>(archive.nb)});
+
+    size_t debut = o.size();
+    const char magique[4] = {'B', 'L', 'K', 'Z'};
+    o.insert(o.end(), magique, magique + 4);
+    ajouter_le(o, archive.nb, 4);
+    ajouter_le(o, 0, 4);            // Taille, complétée plus bas
+    for (size_t c = 0; c < nb_colonnes_archive(archive); c++) {
+        encoder_colonne(o, archive.colonnes[c], archive.nb);
+    }
+    // Multiple de 8 octets, puis 8 octets de marge pour les lectures 64 bits
+    o.resize(debut + ((o.size() - debut + 7) & ~static_cast<size_t>(7)) + 8, 0);
+    uint32_t taille = static_cast<uint32_t>(o.size() - debut - 12);
+    for (size_t k = 0; k < 4; k++) {
+        o[debut + 8 + k] = static_cast<uint8_t>(taille >> (8 * k));
+    }
+
+    archive.trames += archive.nb;
+    archive.nb = 0;
+}
+
+/**
+ * @brief Ajoute une trame brute (39 octets, 45 pour le cobot) au bloc en cours
+ * @return true si le bloc est plein (à fermer)
+ */
+bool archiver_trame(ArchiveCompressee& archive, const uint8_t* trame) {
+    const size_t nb_axes = archive.nb_axes;
+    size_t k = archive.nb++;
+    for (size_t i = 0; i < nb_axes; i++) {
+        const uint8_t* axe = trame + TAILLE_ENTETE + TAILLE_AXE * i;
+        archive.colonnes[i][k] = static_cast<uint16_t>(axe[0] | axe[1] << 8);
+        archive.colonnes[nb_axes + i][k] = static_cast<uint16_t>(axe[2] | axe[3] << 8);
+        archive.colonnes[2 * nb_axes + i][k] = static_cast<uint16_t>(axe[4] | axe[5] << 8);
+    }
+    archive.colonnes[3 * nb_axes][k] = trame[2];
+    return archive.nb == TRAMES_PAR_BLOC;
+}
+
+/**
+ * @brief Ferme le dernier bloc et ajoute l'index et la fin du conteneur
+ */
+void terminer_archive(ArchiveCompressee& archive) {
+    fermer_bloc(archive);
+    std::vector<uint8_t>& o = archive.octets;
+    uint64_t position_index = archive.position + (o.size() - TAILLE_ENTETE_ROBOT);
+    const char index[4] = {'I', 'N', 'D', 'X'};
+    o.insert(o.end(), index, index + 4);
+    ajouter_le(o, archive.index.size(), 4);
+    for (const EntreeIndexConteneur& e : archive.index) {
+        ajouter_le(o, e.position, 8);
+        ajouter_le(o, e.premiere, 8);
+        ajouter_le(o, e.nb, 4);
+        ajouter_le(o, 0, 4);
+    }
+    ajouter_le(o, position_index, 8);
+    const char magique[4] = {'T', 'L', 'M', 'Z'};
+    o.insert(o.end(), magique, magique + 4);
+    ajouter_le(o, 0, 4);
+}
+
+// ============================================================================
+// Génération d'un flux
+// ============================================================================
+
+struct ParametresFlux {
+    uint64_t nb_trames = 0;     // 0 = infini
+    float frequence = 100.0f;   // Hz
+    bool temps_reel = false;
+    bool rapide = false;
+    bool crc = false;           // Format v2 : CRC-32C après chaque trame
+    bool compresse = false;     // Conteneur compressé au lieu des trames brutes
+    size_t nb_axes = NB_AXES_BRAS;  // Modèle de bras (--axes)
+    size_t rafale = 1;          // Trames par envoi (--burst)
+};
+
+/**
+ * @brief Destination d'un flux de robot
+ *
+ * Dans le flux entrelacé, chaque envoi devient un bloc étiqueté, écrit d'un
+ * seul write(2) sous un verrou partagé : les blocs de robots différents ne
+ * se mélangent jamais.
+ */
+struct SortieRobot {
+    int fd = STDOUT_FILENO;
+    int robot = -1;                 // >= 0 : blocs étiquetés (flux entrelacé)
+    std::mutex* verrou = nullptr;
+    bool datagrammes = false;       // Socket UDP : des trames entières par datagramme
+    std::string bilan;              // Cadence obtenue (-r), écrite à la fin
+};
+
+/**
+ * @brief Écrit les octets générés (après la place réservée à l'en-tête)
+ * @param buffer Début du buffer : TAILLE_ENTETE_ROBOT octets réservés, puis les données
+ * @param taille Nombre d'octets de données
+ */
+bool emettre(SortieRobot& sortie, uint8_t* buffer, size_t taille) {
+    if (sortie.robot < 0) {
+        return ecrire_tout(sortie.fd, buffer + TAILLE_ENTETE_ROBOT, taille);
+    }
+    buffer[0] = 'R';
+    buffer[1] = 'B';
+    ecrire_uint16_le(buffer + 2, static_cast<uint16_t>(sortie.robot));
+    ecrire_uint16_le(buffer + 4, static_cast<uint16_t>(taille & 0xFFFF));
+    ecrire_uint16_le(buffer + 6, static_cast<uint16_t>(taille >> 16));
+    std::lock_guard<std::mutex> garde(*sortie.verrou);
+    return ecrire_tout(sortie.fd, buffer, TAILLE_ENTETE_ROBOT + taille);
+}
+
+/**
+ * @brief Émet les octets en attente d'un conteneur compressé
+ */
+bool emettre_archive(SortieRobot& sortie, ArchiveCompressee& archive) {
+    size_t taille = archive.octets.size() - TAILLE_ENTETE_ROBOT;
+    if (taille == 0) {
+        return true;
+    }
+    bool ok = emettre(sortie, archive.octets.data(), taille);
+    archive.position += taille;
+    preparer_octets(archive);
+    return ok;
+}
+
+/**
+ * @brief Génère le flux d'un robot jusqu'à nb_trames (ou indéfiniment)
+ *
+ * En mode --compress, les tirages sont les mêmes qu'en brut (bruit compris) :
+ * le conteneur contient exactement les trames de la capture brute de même
+ * graine.
+ *
+ * Les trames sont envoyées par rafales de params.rafale (ou par blocs de
+ * ~1 Mo en --fast) ; en -r, chaque rafale attend son échéance (Cadence).
+ * En UDP, un envoi est découpé en datagrammes de trames entières.
+ *
+ * @return false sur erreur d'écriture
+ */
+bool generer_flux(Simulateur& sim, const ParametresFlux& params, SortieRobot& sortie) {
+    // Bruit et trames sont construits à la suite dans ce buffer : une rafale
+    // (et son bruit) par envoi, ou ~1 Mo par write(2) en mode --fast
+    const size_t taille_trame = taille_trame_axes(sim.nb_axes);
+    const size_t taille_max_trame = MAX_OCTETS_BRUIT + taille_trame + TAILLE_CRC;
+    const size_t capacite = taille_max_trame * params.rafale +
+                            (params.rapide ? TAILLE_BLOC_ECRITURE : 0);
+    std::vector<uint8_t> buffer(TAILLE_ENTETE_ROBOT + capacite);
+    uint8_t* donnees = buffer.data() + TAILLE_ENTETE_ROBOT;
+    size_t rempli = 0;
+    size_t en_attente = 0;          // Trames dans le buffer
+    std::vector<size_t> bornes;     // UDP : début de chaque datagramme
+    bornes.reserve(capacite / taille_trame + 1);
+
+    std::unique_ptr<ArchiveCompressee> archive;
+    if (params.compresse) {
+        archive.reset(new ArchiveCompressee);
+        ouvrir_archive(*archive, sim.nb_axes);
+    }
+
+    Cadence cadence;
+    if (params.temps_reel) {
+        demarrer_cadence(cadence, params.frequence, params.rafale);
+    }
+    
+    auto envoyer = [&]() {
+        if (params.temps_reel) {
+            attendre_echeance(cadence);
+        }
+        bool ok = sortie.datagrammes ? envoyer_datagrammes(sortie.fd, donnees, bornes, rempli)
+                                     : emettre(sortie, buffer.data(), rempli);
+        rempli = 0;
+        en_attente = 0;
+        bornes.clear();
+        return ok;
+    };
+    
+    // Boucle principale de génération
+    uint64_t compteur = 0;
+    while (params.nb_trames == 0 || compteur < params.nb_trames) {
+        // Datagramme suivant si cette trame risque de ne plus tenir dans celui-ci
+        if (sortie.datagrammes &&
+            (bornes.empty() || rempli - bornes.back() + taille_max_trame > TAILLE_MAX_DATAGRAMME)) {
+            bornes.push_back(rempli);
+        }
+        
+        // Occasionnellement, injecter du bruit avant la trame
+        if (sim.uniforme(sim.rng) < sim.prob_bruit) {
+            int nb = sim.dist_nb_bruit(sim.rng);
+            generer_bruit(sim, donnees + rempli, nb);
+            rempli += static_cast<size_t>(nb);
+        }
+        
+        // Générer la trame (39 octets bruts, 45 pour le cobot, + 4 de CRC)
+        generer_trame(sim, donnees + rempli);
+        if (archive) {
+            // Seule la trame est archivée ; un bloc plein est émis aussitôt
+            bool plein = archiver_trame(*archive, donnees + rempli);
+            rempli = 0;
+            if (plein) {
+                fermer_bloc(*archive);
+                if (!emettre_archive(sortie, *archive)) {
+                    return false;
+                }
+            }
+        } else {
+            if (params.crc) {
+                ajouter_crc(donnees + rempli, taille_trame);
+                rempli += TAILLE_CRC;
+            }
+            rempli += taille_trame;
+        }
+        en_attente++;
+        
+        bool plein = params.rapide ? rempli >= TAILLE_BLOC_ECRITURE : en_attente == params.rafale;
+        if (plein && archive) {
+            if (params.temps_reel) {
+                attendre_echeance(cadence);     // Les blocs archivés suivent la même cadence
+            }
+            en_attente = 0;
+        } else if (plein && !envoyer()) {
+            return false;
+        }
+        
+        compteur++;
+    }
+    
+    bool ok;
+    if (archive) {
+        terminer_archive(*archive);
+        ok = emettre_archive(sortie, *archive);
+    } else {
+        ok = rempli == 0 || envoyer();
+    }
+    if (params.temps_reel) {
+        sortie.bilan = bilan_cadence(cadence, params.frequence, params.rafale);
+    }
+    return ok;
+}
+
+// ============================================================================
+// Relecture d'une capture (--replay)
+// ============================================================================
+//
+// Une capture est réémise telle quelle, octet pour octet, bruit compris. Les
+// captures ne portent pas d'horodatage : le rythme 1× est celui de -f (la
+// fréquence à laquelle la capture a été générée), --speed x le multiplie.
+// Pour cadencer et pour découper les datagrammes UDP, la capture est lue par
+// segments : une trame et le bruit qui la suit, jusqu'au sync suivant.
+//
+// Sans -r, la capture part d'un seul tenant au plus vite et sans copie par
+// le programme (sendfile(2), ou splice(2) vers un pipe) ; à défaut, write(2)
+// depuis la projection.
+
+/**
+ * @brief Capture projetée en mémoire (lecture seule)
+ */
+struct Capture {
+    int fd = -1;
+    const uint8_t* donnees = nullptr;
+    size_t taille = 0;
+};
+
+/**
+ * @brief Ouvre et projette une capture
+ * @return false (message sur stderr) si le fichier est absent ou vide
+ */
+bool ouvrir_capture(Capture& capture, const std::string& nom) {
+    capture.fd = open(nom.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (capture.fd < 0 || fstat(capture.fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+        info.st_size <= 0) {
+        std::cerr << "Erreur: capture " << nom << " absente ou vide\n";
+        if (capture.fd >= 0) {
+            close(capture.fd);
+        }
+        return false;
+    }
+    capture.taille = static_cast<size_t>(info.st_size);
+    void* adresse = mmap(nullptr, capture.taille, PROT_READ, MAP_PRIVATE, capture.fd, 0);
+    if (adresse == MAP_FAILED) {
+        std::cerr << "Erreur: impossible de projeter " << nom << " (" << std::strerror(errno) << ")\n";
+        close(capture.fd);
+        return false;
+    }
+    madvise(adresse, capture.taille, MADV_SEQUENTIAL);
+    capture.donnees = static_cast<const uint8_t*>(adresse);
+    return true;
+}
+
+void fermer_capture(Capture& capture) {
+    if (capture.donnees != nullptr) {
+        munmap(const_cast<uint8_t*>(capture.donnees), capture.taille);
+    }
+    if (capture.fd >= 0) {
+        close(capture.fd);
+    }
+    capture = Capture();
+}
+
+/**
+ * @brief Fin du segment commençant à @p debut : prochain sync au-delà d'une trame
+ */
+size_t fin_segment(const Capture& capture, size_t debut, size_t taille_trame) {
+    size_t pos = std::min(debut + taille_trame, capture.taille);
+    while (pos + 1 < capture.taille) {
+        const void* sync = std::memchr(capture.donnees + pos, SYNC_H, capture.taille - pos - 1);
+        if (sync == nullptr) {
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const uint8_t*>(sync) - capture.donnees);
+        if (capture.donnees[pos + 1] == SYNC_L) {
+            return pos;
+        }
+        pos++;
+    }
+    return capture.taille;
+}
+
+// Moyen d'émission d'une zone de la capture, dégradé au premier refus
+enum MethodeCopie {
+    COPIE_SENDFILE,     // Fichier -> socket, fichier, ou pipe (Linux >= 5.12)
+    COPIE_SPLICE,       // Fichier -> pipe
+    COPIE_WRITE         // Depuis la projection
+};
+
+/**
+ * @brief Émet octets [debut, debut + n) de la capture sur @p fd
+ * @return false sur erreur d'écriture
+ */
+bool emettre_zone(int fd, const Capture& capture, size_t debut, size_t n, MethodeCopie& methode) {
+    while (n > 0) {
+        ssize_t r;
+        if (methode == COPIE_SENDFILE) {
+            off_t position = static_cast<off_t>(debut);
+            r = sendfile(fd, capture.fd, &position, n);
+        } else if (methode == COPIE_SPLICE) {
+            loff_t position = static_cast<loff_t>(debut);
+            r = splice(capture.fd, &position, fd, nullptr, n, SPLICE_F_MOVE);
+        } else {
+            return ecrire_tout(fd, capture.donnees + debut, n);
+        }
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0 && (errno == EINVAL || errno == ENOSYS)) {
+            methode = methode == COPIE_SENDFILE ? COPIE_SPLICE : COPIE_WRITE;
+            continue;
+        }
+        if (r <= 0) {
+            std::cerr << "Erreur d'écriture : " << (r < 0 ? std::strerror(errno) : "fin inattendue")
+                      << "\n";
+            return false;
+        }
+        debut += static_cast<size_t>(r);
+        n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+/**
+ * @brief Réémet une capture sur une sortie (stdout, fichier, udp:, tcp:)
+ *
+ * En -r, chaque rafale de params.rafale segments attend son échéance, à
+ * params.frequence Hz (déjà multipliée par --speed). Le débit obtenu est
+ * rapporté sur stderr.
+ *
+ * @return false sur erreur d'écriture
+ */
+bool rejouer_capture(const Capture& capture, const ParametresFlux& params, SortieRobot& sortie) {
+    const size_t taille_trame = taille_trame_axes(params.nb_axes) + (params.crc ? TAILLE_CRC : 0);
+    MethodeCopie methode = COPIE_SENDFILE;
+    auto debut_ns = std::chrono::steady_clock::now();
+    bool ok = true;
+
+    if (!params.temps_reel && !sortie.datagrammes) {
+        ok = emettre_zone(sortie.fd, capture, 0, capture.taille, methode);
+    } else {
+        Cadence cadence;
+        if (params.temps_reel) {
+            demarrer_cadence(cadence, params.frequence, params.rafale);
+        }
+        std::vector<size_t> bornes;     // UDP : début de chaque datagramme, depuis `debut`
+        size_t pos = 0;
+        while (ok && pos < capture.taille) {
+            size_t debut = pos;
+            bornes.clear();
+            for (size_t k = 0; k < params.rafale && pos < capture.taille; k++) {
+                size_t fin = fin_segment(capture, pos, taille_trame);
+                if (bornes.empty() || fin - debut - bornes.back() > TAILLE_MAX_DATAGRAMME) {
+                    bornes.push_back(pos - debut);
+                }
+                // Un segment plus long qu'un datagramme (long bruit) est coupé
+                // dans son bruit, sa trame restant entière dans le premier
+                while (fin - debut - bornes.back() > TAILLE_MAX_DATAGRAMME) {
+                    bornes.push_back(bornes.back() + TAILLE_MAX_DATAGRAMME);
+                }
+                pos = fin;
+            }
+            if (params.temps_reel) {
+                attendre_echeance(cadence);
+            }
+            ok = sortie.datagrammes
+                ? envoyer_datagrammes(sortie.fd, capture.donnees + debut, bornes, pos - debut)
+                : emettre_zone(sortie.fd, capture, debut, pos - debut, methode);
+        }
+        if (params.temps_reel) {
+            sortie.bilan = bilan_cadence(cadence, params.frequence, params.rafale);
+        }
+    }
+
+    double duree_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut_ns).count();
+    const char* noms[] = {"sendfile", "splice", "write"};
+    std::cerr << std::fixed << std::setprecision(3) << "Relecture : " << capture.taille
+              << " octets en " << duree_s << " s (" << std::setprecision(2)
+              << static_cast<double>(capture.taille) / 1e6 / std::max(duree_s, 1e-9) << " Mo/s"
+              << (sortie.datagrammes ? ", sendmmsg" : ", " + std::string(noms[methode])) << ")\n";
+    return ok;
+}
+
+/**
+ * @brief Nom du fichier d'un robot : chaque "%d" du motif devient son numéro
+ */
+std::string nom_fichier_robot(const std::string& motif, size_t robot) {
+    std::string nom;
+    for (size_t i = 0; i < motif.size(); i++) {
+        if (motif.compare(i, 2, "%d") == 0) {
+            nom += std::to_string(robot);
+            i++;
+        } else {
+            nom += motif[i];
+        }
+    }
+    return nom;
 }
 
 // ============================================================================
@@ -269,7 +1273,7 @@ void generer_bruit(Simulateur& sim, int nb_octets) {
 void afficher_aide(const char* prog) {
     std::cerr << "Usage: " << prog << " [options]\n"
               << "\n"
-              << "Simulateur de télémétrie pour bras robotisé 6 axes.\n"
+              << "Simulateur de télémétrie pour bras robotisé 6 axes (ou cobot 7 axes).\n"
               << "Génère des trames binaires sur stdout.\n"
               << "\n"
               << "Options:\n"
@@ -278,21 +1282,46 @@ void afficher_aide(const char* prog) {
               << "  -b <prob>     Probabilité de bruit entre trames (0.0-1.0, défaut: 0.05)\n"
               << "  -a <prob>     Probabilité d'alerte courant (0.0-1.0, défaut: 0.02)\n"
               << "  -r            Mode temps réel (attente entre trames)\n"
+              << "  --fast        Écrit par blocs d'environ 1 Mo au lieu d'une trame à la fois\n"
+              << "  --seed <n>    Graine du générateur (défaut: aléatoire) ; même graine, même flux\n"
+              << "  --crc         Trames au format v2, suivies d'un CRC-32C (./analyseur --crc)\n"
+              << "  --axes <n>    Modèle de bras : 6 axes (défaut) ou 7 (cobot, ./analyseur --axes 7)\n"
+              << "  --compress    Écrit un conteneur compressé (trames seules, par colonnes)\n"
+              << "  --rng <nom>   Générateur : xoshiro (défaut, rapide) ou mt19937\n"
+              << "  --robots <k>  Simule k bras en parallèle, un fil et un flux aléatoire chacun\n"
+              << "                (sans --output : un flux entrelacé de blocs étiquetés)\n"
+              << "  --output <m>  Un fichier par robot, \"%d\" remplacé par son numéro, ou une\n"
+              << "                destination udp:[hôte:]port ou tcp:[hôte:]port (./analyseur udp:port)\n"
+              << "  --burst <n>   Envoie les trames par rafales de n (défaut: 1) ; en -r, une\n"
+              << "                échéance par rafale, cadence et gigue rapportées sur stderr\n"
+              << "  --replay <f>  Réémet la capture f au lieu de générer (--crc, --axes comme\n"
+              << "                à sa génération) : au plus vite, ou en -r au rythme de -f\n"
+              << "  --speed <x>   Avec --replay -r, rythme de -f multiplié par x (défaut: 1)\n"
               << "  -h            Affiche cette aide\n"
               << "\n"
               << "Exemples:\n"
               << "  " << prog << " -n 100 > donnees.bin    # Fichier de 100 trames\n"
               << "  " << prog << " -r | ./analyseur        # Flux temps réel via pipe\n"
-              << "  " << prog << " -n 1000 -b 0.1 > test.bin  # Avec 10% de bruit\n";
+              << "  " << prog << " -n 1000 -b 0.1 > test.bin  # Avec 10% de bruit\n"
+              << "  " << prog << " --fast -n 100000000 > gros.bin  # Capture de ~4 Go\n"
+              << "  " << prog << " --robots 8 --fast -n 1000000 --output robot_%d.bin\n"
+              << "  " << prog << " --compress -n 8640000 > journee.tlmz  # 24 h à 100 Hz\n"
+              << "  " << prog << " -r -f 10000 --burst 10 --output udp:127.0.0.1:9000\n"
+              << "  " << prog << " --replay incident.bin -r --speed 10 | ./analyseur -\n";
 }
 
 int main(int argc, char* argv[]) {
     // Paramètres par défaut
-    int nb_trames = 0;           // 0 = infini
-    float frequence = 100.0f;    // Hz
+    ParametresFlux params;
     float prob_bruit = 0.05f;    // 5% de chance de bruit
     float prob_alerte = 0.02f;   // 2% de chance d'alerte
-    bool temps_reel = false;
+    TypeGenerateur generateur = GENERATEUR_XOSHIRO;
+    bool graine_fixee = false;
+    uint64_t graine = 0;
+    size_t nb_robots = 1;
+    std::string motif_sortie;    // Vide = stdout
+    std::string capture_rejouee; // --replay
+    float vitesse = 1.0f;        // --speed
     
     // Analyse des arguments
     for (int i = 1; i < argc; i++) {
@@ -300,15 +1329,65 @@ int main(int argc, char* argv[]) {
             afficher_aide(argv[0]);
             return 0;
         } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
-            nb_trames = std::atoi(argv[++i]);
+            params.nb_trames = std::strtoull(argv[++i], nullptr, 10);
         } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
-            frequence = std::atof(argv[++i]);
+            params.frequence = std::atof(argv[++i]);
         } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
             prob_bruit = std::atof(argv[++i]);
         } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
             prob_alerte = std::atof(argv[++i]);
         } else if (strcmp(argv[i], "-r") == 0) {
-            temps_reel = true;
+            params.temps_reel = true;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            params.rapide = true;
+        } else if (strcmp(argv[i], "--crc") == 0) {
+            params.crc = true;
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            params.compresse = true;
+        } else if (strcmp(argv[i], "--axes") == 0 && i + 1 < argc) {
+            long n = std::atol(argv[++i]);
+            if (n < 0 || !nb_axes_pris_en_charge(static_cast<size_t>(n))) {
+                std::cerr << "Erreur: --axes attend " << NB_AXES_BRAS << " ou " << NB_AXES_COBOT << "\n";
+                return 1;
+            }
+            params.nb_axes = static_cast<size_t>(n);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            graine = std::strtoull(argv[++i], nullptr, 0);
+            graine_fixee = true;
+        } else if (strcmp(argv[i], "--rng") == 0 && i + 1 < argc) {
+            const char* nom = argv[++i];
+            if (strcmp(nom, "xoshiro") == 0) {
+                generateur = GENERATEUR_XOSHIRO;
+            } else if (strcmp(nom, "mt19937") == 0) {
+                generateur = GENERATEUR_MT19937;
+            } else {
+                std::cerr << "Erreur: générateur inconnu: " << nom << "\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--robots") == 0 && i + 1 < argc) {
+            long k = std::atol(argv[++i]);
+            if (k < 1 || k > static_cast<long>(MAX_ROBOTS)) {
+                std::cerr << "Erreur: nombre de robots invalide (1 à " << MAX_ROBOTS << ")\n";
+                return 1;
+            }
+            nb_robots = static_cast<size_t>(k);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            motif_sortie = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            capture_rejouee = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            vitesse = std::atof(argv[++i]);
+            if (vitesse <= 0.0f) {
+                std::cerr << "Erreur: vitesse de relecture invalide\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--burst") == 0 && i + 1 < argc) {
+            long n = std::atol(argv[++i]);
+            if (n < 1 || n > static_cast<long>(MAX_RAFALE)) {
+                std::cerr << "Erreur: taille de rafale invalide (1 à " << MAX_RAFALE << ")\n";
+                return 1;
+            }
+            params.rafale = static_cast<size_t>(n);
         } else {
             std::cerr << "Option inconnue: " << argv[i] << "\n";
             std::cerr << "Utilisez -h pour l'aide.\n";
@@ -317,49 +1396,129 @@ int main(int argc, char* argv[]) {
     }
     
     // Validation
-    if (frequence <= 0.0f) {
+    if (params.frequence <= 0.0f) {
         std::cerr << "Erreur: fréquence invalide\n";
         return 1;
     }
+    if (params.compresse && params.crc) {
+        std::cerr << "Note: --crc ignoré avec --compress (le conteneur n'archive que les trames)\n";
+        params.crc = false;
+    }
+    if (params.rapide && params.temps_reel) {
+        std::cerr << "Note: --fast ignoré en mode temps réel (-r)\n";
+        params.rapide = false;
+    }
+    if (nb_robots > 1 && !motif_sortie.empty() &&
+        motif_sortie.find("%d") == std::string::npos) {
+        std::cerr << "Erreur: avec --robots, --output doit contenir %d\n";
+        return 1;
+    }
+    if (params.compresse && nb_robots > 1 && motif_sortie.empty()) {
+        // Les blocs étiquetés du flux entrelacé couperaient chaque conteneur
+        std::cerr << "Erreur: avec --robots, --compress exige --output (un conteneur par robot)\n";
+        return 1;
+    }
+    if (!capture_rejouee.empty() && (nb_robots > 1 || params.compresse)) {
+        std::cerr << "Erreur: --replay réémet une seule capture brute "
+                     "(sans --robots ni --compress)\n";
+        return 1;
+    }
+    if (params.compresse && motif_sortie.compare(0, 4, "udp:") == 0) {
+        std::cerr << "Erreur: un conteneur compressé ne se découpe pas en datagrammes (tcp: ?)\n";
+        return 1;
+    }
     
-    // Initialiser le simulateur
-    Simulateur sim(frequence, prob_bruit, prob_alerte);
+    if (!graine_fixee) {
+        std::random_device rd;
+        graine = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
     
-    // Calculer le délai entre trames pour le mode temps réel
-    auto periode = std::chrono::microseconds(static_cast<int>(1000000.0f / frequence));
+    // Destinations : un fichier par robot, stdout brut (un seul robot) ou
+    // stdout entrelacé et étiqueté
+    std::mutex verrou_sortie;
+    std::vector<SortieRobot> sorties(nb_robots);
+    for (size_t k = 0; k < nb_robots; k++) {
+        SortieRobot& sortie = sorties[k];
+        if (!motif_sortie.empty() && est_adresse_reseau(motif_sortie)) {
+            std::string destination = nom_fichier_robot(motif_sortie, k);
+            sortie.fd = ouvrir_socket(destination);
+            sortie.datagrammes = destination.compare(0, 4, "udp:") == 0;
+            if (sortie.fd < 0) {
+                return 1;
+            }
+        } else if (!motif_sortie.empty()) {
+            std::string nom = nom_fichier_robot(motif_sortie, k);
+            sortie.fd = open(nom.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (sortie.fd < 0) {
+                std::cerr << "Erreur: impossible de créer " << nom << " ("
+                          << std::strerror(errno) << ")\n";
+                return 1;
+            }
+        } else if (nb_robots > 1) {
+            sortie.robot = static_cast<int>(k);
+            sortie.verrou = &verrou_sortie;
+        }
+    }
     
-    // Générateur pour le bruit
-    std::uniform_real_distribution<float> dist_bruit(0.0f, 1.0f);
-    std::uniform_int_distribution<int> dist_nb_bruit(1, 10);
+    // Un fil par robot ; la graine de chaque robot est dérivée de la graine
+    // commune (flux aléatoires distincts, reproductibles avec --seed)
+    Capture capture;
+    if (!capture_rejouee.empty()) {
+        if (!ouvrir_capture(capture, capture_rejouee)) {
+            return 1;
+        }
+        params.frequence *= vitesse;
+    }
     
-    // Boucle principale de génération
-    int compteur = 0;
-    while (nb_trames == 0 || compteur < nb_trames) {
-        auto debut = std::chrono::steady_clock::now();
-        
-        // Occasionnellement, injecter du bruit avant la trame
-        if (dist_bruit(sim.rng) < sim.prob_bruit) {
-            int nb = dist_nb_bruit(sim.rng);
-            generer_bruit(sim, nb);
+    std::vector<char> succes(nb_robots, 0);
+    auto simuler_robot = [&](size_t k) {
+        if (capture.donnees != nullptr) {
+            succes[k] = rejouer_capture(capture, params, sorties[k]);
+            return;
         }
-        
-        // Générer et écrire la trame (39 octets bruts)
-        uint8_t trame[TAILLE_TRAME];
-        generer_trame(sim, trame);
-        std::cout.write(reinterpret_cast<char*>(trame), TAILLE_TRAME);
-        std::cout.flush();
-        
-        compteur++;
-        
-        // Attente pour le mode temps réel
-        if (temps_reel) {
-            auto fin = std::chrono::steady_clock::now();
-            auto duree = std::chrono::duration_cast<std::chrono::microseconds>(fin - debut);
-            if (duree < periode) {
-                std::this_thread::sleep_for(periode - duree);
-            }
+        Simulateur sim(params.nb_axes, params.frequence, prob_bruit, prob_alerte, generateur,
+                       graine + k);
+        succes[k] = generer_flux(sim, params, sorties[k]);
+    };
+    
+    if (nb_robots == 1) {
+        simuler_robot(0);
+    } else {
+        std::vector<std::thread> fils;
+        for (size_t k = 0; k < nb_robots; k++) {
+            fils.emplace_back(simuler_robot, k);
+        }
+        for (auto& f : fils) {
+            f.join();
         }
     }
     
-    return 0;
+    fermer_capture(capture);
+    bool ok = true;
+    for (int m = 0; m < NB_MARQUES_FIN; m++) {
+        bool envoye = false;
+        for (size_t k = 0; k < nb_robots; k++) {
+            if (sorties[k].datagrammes && succes[k]) {
+                send(sorties[k].fd, nullptr, 0, 0);     // Datagramme vide : fin du flux
+                envoye = true;
+            }
+        }
+        if (!envoye) {
+            break;
+        }
+        if (m + 1 < NB_MARQUES_FIN) {
+            std::this_thread::sleep_for(ECART_MARQUES_FIN);
+        }
+    }
+    for (size_t k = 0; k < nb_robots; k++) {
+        ok = ok && succes[k];
+        if (!sorties[k].bilan.empty()) {
+            std::cerr << (nb_robots > 1 ? "Robot " + std::to_string(k) + " : " : "Cadence : ")
+                      << sorties[k].bilan << "\n";
+        }
+        if (!motif_sortie.empty()) {
+            close(sorties[k].fd);
+        }
+    }
+    return ok ? 0 : 1;
 }